@@ -18,11 +18,27 @@
  * v4.1
  *  Created by Todd Morton
  *  Modified for MCUXpresso header file macros
+ * v4.2
+ *  Added BIOGetStrgNB() for non-blocking string input
+ * v4.3
+ *  Added BIODecStrgtoWord() and BIOSetBaud() for arbitrary bit rates
+ * v4.4
+ *  Added BIOSetClk() and BIOFlush() so the bit rate survives clock changes
+ * v4.5
+ *  BIOWrite() and BIORead() run from SRAM_L, see RamFunc.h
+ * v4.6
+ *  Added BIOTxCycles() for the CPU load monitor
  *******************************************************************************************
 * Project master header file
 ********************************************************************/
 #include "MCUType.h"
 #include "BasicIO.h"
+#include "RamFunc.h"
+#include "TimeStamp.h"
+
+#define BIO_UART_CLK_HZ 60000000U    //UART2 runs from the bus clock, 60MHz at boot
+#define BIO_SBR_MAX     0x1FFFU
+#define BIO_DEF_BPS     9600U
 
 /*******************************************************************************************
 * Private Resources
@@ -30,6 +46,12 @@
 static INT8C bioHtoA(INT8U hnib);   //Convert nibble to ascii
 static INT8U bioIsHex(INT8C c);
 static INT8U bioHtoB(INT8C c);
+static INT8U bioStrgCnt = 0;        //Characters entered so far for BIOGetStrgNB()
+static INT32U bioUartClk = BIO_UART_CLK_HZ; //Current UART clock
+static INT32U bioBps = BIO_DEF_BPS;         //Current bit rate
+static INT32U bioTxCyc = 0;                 //Core cycles spent in BIOWrite()
+static const INT32U bioRateTbl[] = {9600U, 19200U, 38400U, 57600U, 115200U};
+static INT8U bioSetDiv(INT32U bps);
 /*******************************************************************************************
  * void BIOOpen(INT8U rate) - Initializes UART to operate at a specified rate.
  * MCU: K65, UART2 configured for debugger USB.
@@ -79,17 +101,101 @@ void BIOOpen(INT8U rate){
         UART2->C4 = 0x14U;
         break;
     }
+    if(rate <= BIO_BIT_RATE_115200){
+        bioBps = bioRateTbl[rate];
+    }else{
+        bioBps = BIO_DEF_BPS;
+    }
     UART2->C2 |= UART_C2_TE_MASK;    //enables transmission
     UART2->C2 |= UART_C2_RE_MASK;    //enables receive
 
 }
 
+/*******************************************************************************************
+* BIOSetBaud() - Changes the UART bit rate to any rate, in bits/s.
+*                Waits for the last character to finish sending.
+*    return: 0 -> if no error.
+*            1 -> if the rate can not be generated from the UART clock.
+*******************************************************************************************/
+INT8U BIOSetBaud(INT32U bps){
+    INT8U rval;
+    BIOFlush();
+    rval = bioSetDiv(bps);
+    if(rval == 0){
+        bioBps = bps;
+    }else{
+    }
+    return rval;
+}
+
+/*******************************************************************************************
+* BIOSetClk() - Tells BasicIO the UART clock changed, in Hz, and recomputes the
+*               divisors for the current bit rate. Call BIOFlush() before changing the
+*               clock.
+*    return: 0 -> if no error.
+*            1 -> if the rate can not be generated from the new clock.
+*                 The rate is then set to 9600bps.
+*******************************************************************************************/
+INT8U BIOSetClk(INT32U uartclk){
+    INT8U rval;
+    bioUartClk = uartclk;
+    rval = bioSetDiv(bioBps);
+    if(rval != 0){
+        bioBps = BIO_DEF_BPS;
+        (void)bioSetDiv(bioBps);
+    }else{
+    }
+    return rval;
+}
+
+/*******************************************************************************************
+* BIOFlush() - Blocks until the last character has been sent.
+*******************************************************************************************/
+void BIOFlush(void){
+    while ((UART2->S1 & UART_S1_TC_MASK)==0){}
+}
+
+/*******************************************************************************************
+* BIOTxCycles() - Core clock cycles spent in BIOWrite() since reset,
+*                 waiting for the transmitter and loading it. Wraps.
+*******************************************************************************************/
+INT32U BIOTxCycles(void){
+    return bioTxCyc;
+}
+
+/*******************************************************************************************
+* bioSetDiv() - Sets the UART divisors for bps from the current UART clock - private
+*    The UART divides its clock by 16*(SBR + BRFA/32) so the divisor is computed
+*    in 1/32 steps, rounded to the nearest step.
+*    return: 0 -> if no error.
+*            1 -> if the rate can not be generated, divisors not changed.
+*******************************************************************************************/
+static INT8U bioSetDiv(INT32U bps){
+    INT32U div32;
+    INT32U sbr;
+    INT8U rval = 0;
+    if(bps == 0){
+        rval = 1;
+    }else{
+        div32 = ((bioUartClk * 2U) + (bps/2U))/bps;
+        sbr = div32 >> 5;
+        if((sbr == 0) || (sbr > BIO_SBR_MAX)){
+            rval = 1;
+        }else{
+            UART2->BDH = (INT8U)((UART2->BDH & ~UART_BDH_SBR_MASK) | UART_BDH_SBR(sbr >> 8));
+            UART2->BDL = (INT8U)(sbr & 0xFFU);        //BDL write updates the rate
+            UART2->C4 = (INT8U)((UART2->C4 & ~UART_C4_BRFA_MASK) | UART_C4_BRFA(div32 & 0x1FU));
+        }
+    }
+    return rval;
+}
+
 /*******************************************************************************************
 * BIORead() - Checks for a character received
 *    MCU: K65, UART2
 *    return: ASCII character received or 0 if no character received
 *******************************************************************************************/
-INT8C BIORead(void){
+RAMFUNC INT8C BIORead(void){
     INT8C c;
     if ((UART2->S1 & UART_S1_RDRF_MASK) != 0){   //check if char received
         c = UART2->D;
@@ -116,9 +222,11 @@ INT8C BIOGetChar(void){
 *    MCU: K65, UART2
 *    parameter: c is the ASCII character to be sent
 *******************************************************************************************/
-void BIOWrite(INT8C c){
+RAMFUNC void BIOWrite(INT8C c){
+    INT32U start = TS_GET();
     while ((UART2->S1 & UART_S1_TDRE_MASK)==0){} //waits until transmission
     UART2->D = (INT8U)c;                             //is ready
+    bioTxCyc += TS_GET() - start;
 }
 
 /*******************************************************************************************
@@ -293,6 +401,51 @@ INT8U BIOGetStrg(INT8U strglen,INT8C *const strg){
    return rvalue;
 }
 
+/*******************************************************************************************
+* BIOGetStrgNB() - Non-blocking version of BIOGetStrg().
+*
+* Description: Processes at most one received character per call and returns immediately.
+*              Editing, echo and length rules are the same as BIOGetStrg(). The partial
+*              string is kept in strg between calls so strg must stay valid until the
+*              string is complete. Only one string can be in progress.
+* Return value: BIO_STRG_CR      -> string ended with CR
+*               BIO_STRG_TOOLONG -> strglen exceeded
+*               BIO_STRG_PENDING -> string not complete yet
+* Arguments: *strg is a pointer to the string array
+*            strglen is the max string length, includes CR/NULL.
+*******************************************************************************************/
+INT8U BIOGetStrgNB(INT8U strglen,INT8C *const strg){
+    INT8C c;
+    INT8U rvalue = BIO_STRG_PENDING;
+    c = BIORead();
+    if(c == '\0'){ /* nothing received */
+    }else if(c == '\r'){
+        BIOOutCRLF();
+        strg[bioStrgCnt] = '\0';
+        bioStrgCnt = 0;
+        rvalue = BIO_STRG_CR;
+    }else if((' ' <= c) && ('~' >= c) && (bioStrgCnt < (strglen-1))){
+        BIOWrite(c);
+        strg[bioStrgCnt] = c;
+        bioStrgCnt++;
+    }else if(c == '\b'){
+        if(bioStrgCnt > 0){
+            BIOWrite('\b');
+            BIOWrite(' ');
+            BIOWrite('\b');
+            bioStrgCnt--;
+        }else{
+        }
+    }else if((' ' <= c) && ('~' >= c)){
+        BIOOutCRLF();
+        strg[bioStrgCnt] = '\0';
+        bioStrgCnt = 0;
+        rvalue = BIO_STRG_TOOLONG;
+    }else{ /*non-printable character - ignore */
+    }
+    return rvalue;
+}
+
 /*******************************************************************************************
 * BIOOutCRLF() - Outputs a carriage return and line feed.
 *
@@ -337,6 +490,42 @@ INT8U BIOHexStrgtoWord(INT8C *const strg,INT32U *bin){
     return rval;
 }
 
+/*******************************************************************************************
+* BIODecStrgtoWord() - Converts a string of decimal characters to a
+*                      32-bit word until NULL is reached.
+* Return value: 0 -> if no error.
+*               1 -> if the value is too large for a word.
+*               2 -> if a non-decimal character is in the string.
+*               3 -> No characters in string. Started with NULL.
+* Arguments: *strg is a pointer to the string array
+*            *bin is the word that will hold the converted string.
+*******************************************************************************************/
+INT8U BIODecStrgtoWord(INT8C *const strg,INT32U *bin){
+    INT32U lbin = 0;
+    INT32U dig;
+    INT8C *strgptr = strg;
+    INT8U rval = 0;
+    if(*strgptr == '\0'){
+        rval = 3;
+    }else{
+        while(*strgptr != '\0'){
+            if(('0' <= *strgptr) && ('9' >= *strgptr)){
+                dig = (INT32U)(*strgptr - '0');
+                if(lbin > ((0xFFFFFFFFU - dig)/10U)){
+                    rval = 1;
+                }else{
+                    lbin = (lbin * 10U) + dig;
+                }
+            }else{
+                rval = 2;
+            }
+            strgptr++;
+        }
+        *bin = lbin;
+    }
+    return rval;
+}
+
 /*******************************************************************************************
 * BIOOutHexByte() - Output one byte in hex.
 * bin is the byte to be sent
@@ -18,6 +18,16 @@
  * v4.1
  *  Created by Todd Morton
  *  Modified for MCUXpresso header file macros
+ * v4.2
+ *  Added BIOGetStrgNB() for non-blocking string input
+ * v4.3
+ *  Added BIODecStrgtoWord() and BIOSetBaud() for arbitrary bit rates
+ * v4.4
+ *  Added BIOSetClk() and BIOFlush() so the bit rate survives clock changes
+ * v4.5
+ *  BIOWrite() and BIORead() run from SRAM_L, see RamFunc.h
+ * v4.6
+ *  Added BIOTxCycles() for the CPU load monitor
 ********************************************************************/
 #ifndef BIO_INCL
 #define BIO_INCL
@@ -31,6 +41,13 @@
 #define BIO_BIT_RATE_57600  3
 #define BIO_BIT_RATE_115200 4
 
+/******************************************************************************************
+ * BIOGetStrgNB() return values
+ ******************************************************************************************/
+#define BIO_STRG_CR         0U
+#define BIO_STRG_TOOLONG    1U
+#define BIO_STRG_PENDING    2U
+
 /********************************************************************
 * Public Function Prototypes 
 ********************************************************************/
@@ -45,6 +62,35 @@
 ********************************************************************/
 void BIOOpen(INT8U rate);
 
+/********************************************************************
+* BIOSetBaud() - Changes the UART bit rate to any rate, in bits/s.
+*                Waits for the last character to finish sending.
+*    return: 0 -> if no error.
+*            1 -> if the rate can not be generated from the UART clock.
+********************************************************************/
+INT8U BIOSetBaud(INT32U bps);
+
+/********************************************************************
+* BIOSetClk() - Tells BasicIO the UART clock changed, in Hz, and
+*               recomputes the divisors for the current bit rate.
+*               Call BIOFlush() before changing the clock.
+*    return: 0 -> if no error.
+*            1 -> if the rate can not be generated from the new clock.
+*                 The rate is then set to 9600bps.
+********************************************************************/
+INT8U BIOSetClk(INT32U uartclk);
+
+/********************************************************************
+* BIOFlush() - Blocks until the last character has been sent.
+********************************************************************/
+void BIOFlush(void);
+
+/********************************************************************
+* BIOTxCycles() - Core clock cycles spent in BIOWrite() since reset,
+*                 waiting for the transmitter and loading it. Wraps.
+********************************************************************/
+INT32U BIOTxCycles(void);
+
 /********************************************************************
 * BIORead() - Checks for a character received
 *    return: ASCII character received or 0 if no character received
@@ -74,6 +120,22 @@ INT8C BIOGetChar(void);  /* Blocks until a character is received */
 ********************************************************************/
 INT8U BIOGetStrg(INT8U strglen,INT8C *const strg); /*input a string */
 
+/********************************************************************
+* BIOGetStrgNB() - Non-blocking version of BIOGetStrg().
+*
+* Description: Processes at most one received character per call and
+*              returns immediately. Editing, echo and length rules are
+*              the same as BIOGetStrg(). The partial string is kept in
+*              strg between calls so strg must stay valid until the
+*              string is complete. Only one string can be in progress.
+* Return value: BIO_STRG_CR      -> string ended with CR
+*               BIO_STRG_TOOLONG -> strglen exceeded
+*               BIO_STRG_PENDING -> string not complete yet
+* Arguments: *strg is a pointer to the string array
+*            strglen is the max string length, includes CR/NULL.
+********************************************************************/
+INT8U BIOGetStrgNB(INT8U strglen,INT8C *const strg);
+
 /********************************************************************
 * BIOWrite() - Sends an ASCII character
 *              Blocks as much as one character time
@@ -149,5 +211,17 @@ void BIOOutHexWord(INT32U bin);
 *            *bin is the word that will hold the converted string.
 ********************************************************************/
 INT8U BIOHexStrgtoWord(INT8C *const strg,INT32U *bin);
+
+/********************************************************************
+* BIODecStrgtoWord() - Converts a string of decimal characters to a
+*                      32-bit word until NULL is reached.
+* Return value: 0 -> if no error.
+*               1 -> if the value is too large for a word.
+*               2 -> if a non-decimal character is in the string.
+*               3 -> No characters in string. Started with NULL.
+* Arguments: *strg is a pointer to the string array
+*            *bin is the word that will hold the converted string.
+********************************************************************/
+INT8U BIODecStrgtoWord(INT8C *const strg,INT32U *bin);
 /*******************************************************************/
 #endif
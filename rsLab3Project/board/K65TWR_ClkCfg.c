@@ -16,6 +16,31 @@
 #include "MCUType.h"
 #include "K65TWR_ClkCfg.h"
 
+/* SIM_CLKDIV1 for each runtime profile, indexed by K65TWR_CLK_xxx */
+#define K65TWR_FEI_CLKDIV1             0x00110000U   /* OUTDIV1=0,OUTDIV2=0,OUTDIV3=1,OUTDIV4=1 */
+#define K65TWR_PEE180_CLKDIV1          0x02260000U   /* OUTDIV1=0,OUTDIV2=2,OUTDIV3=2,OUTDIV4=6 */
+#define K65TWR_BLPI_CLKDIV1            0x00040000U   /* OUTDIV1=0,OUTDIV2=0,OUTDIV3=0,OUTDIV4=4 */
+#define K65TWR_PEE120_CLKDIV1          0x01140000U   /* OUTDIV1=0,OUTDIV2=1,OUTDIV3=1,OUTDIV4=4 */
+#define K65TWR_PEE180_VDIV             0x1DU         /* x45 */
+#define K65TWR_PEE120_VDIV             0x0EU         /* x30 */
+#define K65TWR_PMSTAT_RUN              0x01U
+#define K65TWR_PMSTAT_HSRUN            0x80U
+
+#if (CLOCK_SETUP == 0)
+static INT8U k65ClkProfile = K65TWR_CLK_FEI;
+#elif (CLOCK_SETUP == 1)
+static INT8U k65ClkProfile = K65TWR_CLK_PEE180;
+#elif (CLOCK_SETUP == 2)
+static INT8U k65ClkProfile = K65TWR_CLK_BLPI;
+#elif (CLOCK_SETUP == 5)
+static INT8U k65ClkProfile = K65TWR_CLK_PEE120;
+#else
+static INT8U k65ClkProfile = K65TWR_CLK_UNKNOWN;
+#endif
+
+static void k65ToFBI(void);
+static void k65Wait1ms(void);
+
 /****************************************************************************************
  * Configure and start the system clocks based on the settings in K65TWR_ClkCfg.h
  * Todd Morton, 09/06/2018
@@ -247,4 +272,131 @@ void K65TWR_BootClock(void){
         NVIC_EnableIRQ(MCG_IRQn);          /* Enable PLL loss of lock interrupt request */
     }
 #endif
+    SystemCoreClockUpdate();               /* Keep SystemCoreClock in step with the MCG */
+}
+
+/****************************************************************************************
+ * Switch between clock profiles at run time. Every switch first drops to FBI running
+ * from the 4MHz fast IRC, which can be reached from and left to any of the profiles
+ * with legal MCG transitions. HSRUN is only left once the core runs from a slow
+ * clock and only entered before the PLL is selected.
+ * *************************************************************************************/
+INT8U K65TWR_SetClock(INT8U profile){
+    INT8U rval = 0;
+    INT8U vdiv;
+    if(profile >= K65TWR_CLK_NUM){
+        rval = 1;
+    }else{
+        k65ToFBI();
+        switch(profile){
+        case(K65TWR_CLK_FEI):
+            SIM->CLKDIV1 = K65TWR_FEI_CLKDIV1;
+            MCG->C4 &= (INT8U)~(MCG_C4_DMX32_MASK | MCG_C4_DRST_DRS_MASK);  /* 640 x 32.768kHz */
+            MCG->C1 = (INT8U)((MCG->C1 & (INT8U)~MCG_C1_CLKS_MASK) | MCG_C1_IREFS_MASK);
+            while((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(0)) {}  /* Wait for FLL output */
+            k65Wait1ms();                                           /* FLL stabilization */
+            break;
+        case(K65TWR_CLK_BLPI):
+            SIM->CLKDIV1 = K65TWR_BLPI_CLKDIV1;
+            MCG->C2 |= MCG_C2_LP_MASK;                              /* FBI -> BLPI */
+            break;
+        case(K65TWR_CLK_PEE180):
+        case(K65TWR_CLK_PEE120):
+            /* FBI -> FBE with the 16MHz crystal */
+            OSC->CR = SYSTEM_OSC_CR_VALUE;
+            MCG->C2 = (INT8U)((MCG->C2 & (INT8U)~(MCG_C2_RANGE_MASK | MCG_C2_LP_MASK)) | MCG_C2_RANGE(2) | MCG_C2_EREFS_MASK);
+            MCG->C1 = (INT8U)(MCG_C1_CLKS(2) | MCG_C1_FRDIV(4) | MCG_C1_IRCLKEN_MASK);
+            while((MCG->S & MCG_S_OSCINIT0_MASK) == 0x00U) {}
+            while((MCG->S & MCG_S_IREFST_MASK) != 0x00U) {}
+            while((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(2)) {}
+            if(profile == K65TWR_CLK_PEE180){
+                /* HSRUN must be entered before the core goes above 120MHz */
+                SMC->PMPROT = SYSTEM_SMC_PMPROT_VALUE;
+                SMC->PMCTRL = (INT8U)((SMC->PMCTRL & (INT8U)~SMC_PMCTRL_RUNM_MASK) | SMC_PMCTRL_RUNM(3));
+                while(SMC->PMSTAT != K65TWR_PMSTAT_HSRUN) {}
+                SIM->CLKDIV1 = K65TWR_PEE180_CLKDIV1;
+                vdiv = K65TWR_PEE180_VDIV;
+            }else{
+                SIM->CLKDIV1 = K65TWR_PEE120_CLKDIV1;
+                vdiv = K65TWR_PEE120_VDIV;
+            }
+            /* FBE -> PBE: 16MHz/2 x 45 / 2 = 180MHz, x 30 / 2 = 120MHz */
+            MCG->C5 = MCG_C5_PRDIV(1);
+            MCG->C6 = (INT8U)(MCG_C6_PLLS_MASK | MCG_C6_VDIV(vdiv));
+            while((MCG->S & MCG_S_PLLST_MASK) == 0x00U) {}
+            while((MCG->S & MCG_S_LOCK0_MASK) == 0x00U) {}
+            /* PBE -> PEE */
+            MCG->C1 &= (INT8U)~MCG_C1_CLKS_MASK;
+            while((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(3)) {}
+            break;
+        default:
+            break;
+        }
+        k65ClkProfile = profile;
+        SystemCoreClockUpdate();
+    }
+    return rval;
+}
+
+/****************************************************************************************
+ * Returns the current clock profile
+ * *************************************************************************************/
+INT8U K65TWR_GetClock(void){
+    return k65ClkProfile;
+}
+
+/****************************************************************************************
+ * Returns the bus clock frequency in Hz
+ * *************************************************************************************/
+INT32U K65TWR_BusClock(void){
+    INT32U mcgout;
+    mcgout = SystemCoreClock * (((SIM->CLKDIV1 & SIM_CLKDIV1_OUTDIV1_MASK) >> SIM_CLKDIV1_OUTDIV1_SHIFT) + 1U);
+    return mcgout/(((SIM->CLKDIV1 & SIM_CLKDIV1_OUTDIV2_MASK) >> SIM_CLKDIV1_OUTDIV2_SHIFT) + 1U);
+}
+
+/****************************************************************************************
+ * k65ToFBI() - Moves the MCG from any of the runtime profiles to FBI mode on the 4MHz
+ *              fast IRC. PEE -> PBE -> FBE -> FBI, BLPI -> FBI, FEI -> FBI.
+ *              Leaves HSRUN and sets slow dividers on the way. Private.
+ * *************************************************************************************/
+static void k65ToFBI(void){
+    /* PEE -> PBE */
+    if((MCG->S & MCG_S_CLKST_MASK) == MCG_S_CLKST(3)){
+        MCG->C1 = (INT8U)((MCG->C1 & (INT8U)~MCG_C1_CLKS_MASK) | MCG_C1_CLKS(2));
+        while((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(2)) {}
+    }
+    /* PBE -> FBE */
+    if((MCG->C6 & MCG_C6_PLLS_MASK) != 0x00U){
+        MCG->C6 &= (INT8U)~MCG_C6_PLLS_MASK;
+        while((MCG->S & MCG_S_PLLST_MASK) != 0x00U) {}
+    }
+    /* Core is now at most 20.97MHz so HSRUN can be left */
+    if(SMC->PMSTAT == K65TWR_PMSTAT_HSRUN){
+        SMC->PMCTRL &= (INT8U)~SMC_PMCTRL_RUNM_MASK;
+        while(SMC->PMSTAT != K65TWR_PMSTAT_RUN) {}
+    }
+    /* BLPI -> FBI */
+    MCG->C2 &= (INT8U)~MCG_C2_LP_MASK;
+    /* Fast IRC divided by 1, leave the w1c flags alone */
+    MCG->SC &= (INT8U)~(MCG_SC_FCRDIV_MASK | MCG_SC_LOCS0_MASK | MCG_SC_ATMF_MASK);
+    MCG->C2 |= MCG_C2_IRCS_MASK;
+    while((MCG->S & MCG_S_IRCST_MASK) == 0x00U) {}
+    /* FEI/FBE -> FBI */
+    MCG->C1 = (INT8U)((MCG->C1 & (INT8U)~MCG_C1_CLKS_MASK) | MCG_C1_CLKS(1) | MCG_C1_IREFS_MASK | MCG_C1_IRCLKEN_MASK);
+    while((MCG->S & MCG_S_IREFST_MASK) == 0x00U) {}
+    while((MCG->S & MCG_S_CLKST_MASK) != MCG_S_CLKST(1)) {}
+    SIM->CLKDIV1 = K65TWR_BLPI_CLKDIV1;
+}
+
+/****************************************************************************************
+ * k65Wait1ms() - Uses the LPTMR on the 1kHz LPO to wait for 1ms. Private.
+ * *************************************************************************************/
+static void k65Wait1ms(void){
+    SIM->SCGC5 |= SIM_SCGC5_LPTMR_MASK;  /* Allow software control of LPMTR */
+    LPTMR0->CMR = LPTMR_CMR_COMPARE(0);  /* Default 1 LPO tick */
+    LPTMR0->CSR = (LPTMR_CSR_TCF_MASK | LPTMR_CSR_TPS(0x00));
+    LPTMR0->PSR = (LPTMR_PSR_PCS(0x01) | LPTMR_PSR_PBYP_MASK); /* Clock source: LPO, Prescaler bypass enable */
+    LPTMR0->CSR = LPTMR_CSR_TEN_MASK;    /* LPMTR enable */
+    while((LPTMR0->CSR & LPTMR_CSR_TCF_MASK) == 0u) {}
+    LPTMR0->CSR = 0x00;                  /* Disable LPTMR */
 }
@@ -58,8 +58,10 @@
          Reference clock source for MCG module: System oscillator 0 reference clock
          Core clock = 120MHz
          Bus clock  = 60MHz
+   Flash cannot be programmed in HSRUN, so the board boots with 5 for the counter
+   log. K65TWR_SetClock(K65TWR_CLK_PEE180) gives 180MHz when it is needed.
 */
-#define CLOCK_SETUP 1
+#define CLOCK_SETUP 5
 
 /* Define clock source values */
 
@@ -260,7 +262,7 @@
   /* SIM_SOPT2: SDHCSRC=0,LPUARTSRC=0,TPMSRC=1,TIMESRC=0,RMIISRC=0,USBSRC=0,PLLFLLSEL=1,TRACECLKSEL=0,FBSL=0,CLKOUTSEL=0,RTCCLKOUTSEL=0,USBREGEN=0,USBSLSRC=0 */
   #define SYSTEM_SIM_SOPT2_VALUE       0x01010000U         /* SIM_SOPT2 */
 #elif (CLOCK_SETUP == 5)
-  #define DEFAULT_SYSTEM_CLOCK         120000000U          /* Default System clock value */
+//  #define DEFAULT_SYSTEM_CLOCK         120000000U          /* Default System clock value */
   #define MCG_MODE                     MCG_MODE_PEE /* Clock generator mode */
   /* MCG_C1: CLKS=0,FRDIV=4,IREFS=0,IRCLKEN=1,IREFSTEN=0 */
   #define SYSTEM_MCG_C1_VALUE          0x22U               /* MCG_C1 */
@@ -301,8 +303,42 @@
 
 
 /****************************************************************************************
- * Function to configure the system clock to high-speed, 180MHz
+ * Function to configure the system clock as selected by CLOCK_SETUP
  ***************************************************************************************/
 void K65TWR_BootClock(void);
 
+/****************************************************************************************
+ * Runtime clock profiles for K65TWR_SetClock()
+ *   FEI     - FLL from slow internal reference, core = bus = 20.97152MHz
+ *   PEE180  - PLL from 16MHz crystal, HSRUN, core = 180MHz, bus = 60MHz
+ *   BLPI    - Fast internal reference, FLL and PLL off, core = bus = 4MHz
+ *   PEE120  - PLL from 16MHz crystal, RUN, core = 120MHz, bus = 60MHz
+ ***************************************************************************************/
+#define K65TWR_CLK_FEI                 0U
+#define K65TWR_CLK_PEE180              1U
+#define K65TWR_CLK_BLPI                2U
+#define K65TWR_CLK_PEE120              3U
+#define K65TWR_CLK_NUM                 4U
+#define K65TWR_CLK_UNKNOWN             0xFFU
+
+/****************************************************************************************
+ * Switch between clock profiles at run time. Walks the MCG through legal mode
+ * transitions (via FBI), enters or leaves HSRUN as needed and updates
+ * SystemCoreClock. Peripherals running from the bus clock must be retuned by
+ * the caller, see K65TWR_BusClock().
+ * Returns 0 if switched, 1 if profile is not valid.
+ ***************************************************************************************/
+INT8U K65TWR_SetClock(INT8U profile);
+
+/****************************************************************************************
+ * Returns the current clock profile, K65TWR_CLK_UNKNOWN if it was not set by
+ * K65TWR_BootClock() or K65TWR_SetClock().
+ ***************************************************************************************/
+INT8U K65TWR_GetClock(void);
+
+/****************************************************************************************
+ * Returns the bus clock frequency in Hz, derived from SystemCoreClock and SIM_CLKDIV1.
+ ***************************************************************************************/
+INT32U K65TWR_BusClock(void);
+
 #endif  /* #if !defined(K65TWR_CLKCFG_H_) */
@@ -0,0 +1,102 @@
+/******************************************************************************************
+ * PinCfg.c - Port pin configuration for the K65TWR.
+ *
+ *   Grown out of GPIOAPeriphIni() in Counter.c, which only set the mux and
+ *   interrupt code of a PORTA pin.
+ ******************************************************************************************/
+#include "MCUType.h"
+#include "PinCfg.h"
+
+/******************************************************************************************
+ * Private Resources
+ ******************************************************************************************/
+static PORT_Type *const pinPorts[PIN_NUM_PORTS] = {PORTA, PORTB, PORTC, PORTD, PORTE};
+static const INT32U pinClkGates[PIN_NUM_PORTS] = {
+    SIM_SCGC5_PORTA_MASK, SIM_SCGC5_PORTB_MASK, SIM_SCGC5_PORTC_MASK,
+    SIM_SCGC5_PORTD_MASK, SIM_SCGC5_PORTE_MASK
+};
+
+/******************************************************************************************
+ * PinConfig() - Configures one pin. Enables the port clock.
+ *    Parameters: port is PIN_PORTx, pin is 0-31
+ *                mux is the PCR MUX code, irqc the PCR IRQC code
+ *                opts are PIN_OPT_xxx
+ ******************************************************************************************/
+void PinConfig(INT8U port, INT8U pin, INT8U mux, INT8U irqc, INT8U opts){
+    PORT_Type *base;
+    INT32U pcr;
+    if(port < PIN_NUM_PORTS){
+        base = pinPorts[port];
+        SIM->SCGC5 |= pinClkGates[port];
+        pcr = PORT_PCR_MUX(mux) | PORT_PCR_IRQC(irqc);
+        if((opts & PIN_OPT_PULLUP) != 0){
+            pcr |= PORT_PCR_PE_MASK | PORT_PCR_PS_MASK;
+        }else if((opts & PIN_OPT_PULLDOWN) != 0){
+            pcr |= PORT_PCR_PE_MASK;
+        }else{
+        }
+        if((opts & PIN_OPT_PASSIVE) != 0){
+            pcr |= PORT_PCR_PFE_MASK;
+        }else{
+        }
+        base->PCR[pin] = pcr;
+        if((opts & PIN_OPT_DIGITAL) != 0){
+            base->DFER |= (1UL << pin);
+        }else{
+            base->DFER &= ~(1UL << pin);
+        }
+    }else{
+    }
+}
+
+/******************************************************************************************
+ * PinIrqSet() - Changes only the IRQC code of a pin, leaving the flag untouched.
+ ******************************************************************************************/
+void PinIrqSet(INT8U port, INT8U pin, INT8U irqc){
+    PORT_Type *base;
+    if(port < PIN_NUM_PORTS){
+        base = pinPorts[port];
+        /* ISF is write 1 to clear, so it must not be written back */
+        base->PCR[pin] = (base->PCR[pin] & ~(PORT_PCR_IRQC_MASK | PORT_PCR_ISF_MASK)) |
+                         PORT_PCR_IRQC(irqc);
+    }else{
+    }
+}
+
+/******************************************************************************************
+ * PinFilterClock() - Sets the digital filter clock and width of a port.
+ *    Parameters: clk is PIN_FILT_BUS or PIN_FILT_LPO
+ *                width is the number of filter clocks, 0 bypasses the filter
+ *    Note: The filter is turned off for the whole port while it is changed, as
+ *          the reference manual requires.
+ ******************************************************************************************/
+void PinFilterClock(INT8U port, INT8U clk, INT8U width){
+    PORT_Type *base;
+    INT32U dfer;
+    if(port < PIN_NUM_PORTS){
+        base = pinPorts[port];
+        SIM->SCGC5 |= pinClkGates[port];
+        if(width > PIN_FILT_MAX_WIDTH){
+            width = PIN_FILT_MAX_WIDTH;
+        }else{
+        }
+        dfer = base->DFER;
+        base->DFER = 0;
+        base->DFCR = PORT_DFCR_CS(clk);
+        base->DFWR = PORT_DFWR_FILT(width);
+        base->DFER = dfer;
+    }else{
+    }
+}
+
+/******************************************************************************************
+ * PinPort() - Register block of a port, 0 for an unknown port.
+ ******************************************************************************************/
+PORT_Type *PinPort(INT8U port){
+    PORT_Type *base = 0;
+    if(port < PIN_NUM_PORTS){
+        base = pinPorts[port];
+    }else{
+    }
+    return base;
+}
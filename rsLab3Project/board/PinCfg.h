@@ -0,0 +1,73 @@
+/******************************************************************************************
+ * PinCfg.h - Port pin configuration for the K65TWR.
+ *
+ *   Sets the mux, interrupt/DMA request, pull and filters of one pin, and the
+ *   digital filter clock of a port. The digital filter clock and width are
+ *   shared by every pin of a port, each pin only enables or disables it.
+ *
+ *   With the digital filter enabled a pin change only reaches the interrupt
+ *   logic once the new level has been stable for the filter width, measured
+ *   in bus clocks (at most 31, about 0.5us at 60MHz) or in 1kHz LPO periods
+ *   (up to 31ms). Only the LPO clock is slow enough for switch bounce. The
+ *   passive filter removes glitches of about 10-50ns.
+ ******************************************************************************************/
+#ifndef PIN_INCL
+#define PIN_INCL
+
+/******************************************************************************************
+ * Ports
+ ******************************************************************************************/
+#define PIN_PORTA           0U
+#define PIN_PORTB           1U
+#define PIN_PORTC           2U
+#define PIN_PORTD           3U
+#define PIN_PORTE           4U
+#define PIN_NUM_PORTS       5U
+
+/******************************************************************************************
+ * PinConfig() options, or'd together
+ ******************************************************************************************/
+#define PIN_OPT_NONE        0x00U
+#define PIN_OPT_PULLUP      0x01U
+#define PIN_OPT_PULLDOWN    0x02U
+#define PIN_OPT_PASSIVE     0x04U   /* Passive input filter */
+#define PIN_OPT_DIGITAL     0x08U   /* Port digital filter, see PinFilterClock() */
+
+/******************************************************************************************
+ * Digital filter clocks
+ ******************************************************************************************/
+#define PIN_FILT_BUS        0U
+#define PIN_FILT_LPO        1U
+#define PIN_FILT_MAX_WIDTH  31U
+
+/******************************************************************************************
+ * Public Function Prototypes
+ ******************************************************************************************/
+/******************************************************************************************
+ * PinConfig() - Configures one pin. Enables the port clock.
+ *    Parameters: port is PIN_PORTx, pin is 0-31
+ *                mux is the PCR MUX code, irqc the PCR IRQC code
+ *                opts are PIN_OPT_xxx
+ ******************************************************************************************/
+void PinConfig(INT8U port, INT8U pin, INT8U mux, INT8U irqc, INT8U opts);
+
+/******************************************************************************************
+ * PinIrqSet() - Changes only the IRQC code of a pin, leaving the flag untouched.
+ ******************************************************************************************/
+void PinIrqSet(INT8U port, INT8U pin, INT8U irqc);
+
+/******************************************************************************************
+ * PinFilterClock() - Sets the digital filter clock and width of a port.
+ *    Parameters: clk is PIN_FILT_BUS or PIN_FILT_LPO
+ *                width is the number of filter clocks, 0 bypasses the filter
+ *    Note: The filter is turned off for the whole port while it is changed, as
+ *          the reference manual requires.
+ ******************************************************************************************/
+void PinFilterClock(INT8U port, INT8U clk, INT8U width);
+
+/******************************************************************************************
+ * PinPort() - Register block of a port, 0 for an unknown port.
+ ******************************************************************************************/
+PORT_Type *PinPort(INT8U port);
+
+#endif
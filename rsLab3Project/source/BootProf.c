@@ -0,0 +1,122 @@
+/****************************************************************************************
+* BootProf.c - Boot phase profiler.
+*
+*   Records a DWT cycle counter time stamp at the end of each startup phase, from
+*   the first instruction of ResetISR to the first user prompt. The record is kept
+*   in a no-init RAM section so it is not touched by data_init()/bss_init(), which
+*   run while it is being filled.
+*
+*   The core runs from the 20.97MHz reset clock until K65TWR_BootClock() switches
+*   to the PLL, so microseconds for phases up to and including BP_CLOCK are
+*   computed with the reset clock. The clock phase is therefore approximate since
+*   its last few steps already run at full speed. Cycle counts are exact.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "BootProf.h"
+
+#define BP_MAGIC        0xB007C1C5U
+#define BP_RESET_CLK_HZ 20971520U       /* FEI clock out of reset */
+#define BP_NAME_COL     22U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+typedef struct{
+    INT32U magic;
+    INT32U stamp[BP_NUM_MARKS];
+}BP_RECORD;
+
+static BP_RECORD bpRecord __attribute__ ((section(".noinit")));
+
+static const INT8C *const bpNames[BP_NUM_MARKS] = {
+    "Reset",
+    "SystemInit",
+    "data_init",
+    "bss_init",
+    "Runtime init",
+    "K65TWR_BootClock",
+    "BIOOpen",
+    "CalcChkSum",
+    "Counters and prompt",
+};
+
+/****************************************************************************************
+* BootProfStart() - Starts the DWT cycle counter from zero and clears the record.
+*                   Must be the first call in ResetISR. Uses no initialized data.
+****************************************************************************************/
+void BootProfStart(void){
+    INT8U i;
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    for(i = 0; i < BP_NUM_MARKS; i++){
+        bpRecord.stamp[i] = 0;
+    }
+    bpRecord.magic = BP_MAGIC;
+}
+
+/****************************************************************************************
+* BootProfMark() - Stamps the end of a boot phase. Uses no initialized data.
+****************************************************************************************/
+void BootProfMark(INT8U phase){
+    if(phase < BP_NUM_MARKS){
+        bpRecord.stamp[phase] = DWT->CYCCNT;
+    }else{
+    }
+}
+
+/****************************************************************************************
+* BootProfOut() - Outputs each phase's duration in core cycles and microseconds.
+*                 Phases that were not marked are shown as '-' and their time is
+*                 counted in the next marked phase.
+****************************************************************************************/
+void BootProfOut(void){
+    INT8U i;
+    INT8U col;
+    INT32U last = 0;
+    INT32U cycles;
+    INT32U hz;
+    INT32U total_us = 0;
+
+    if(bpRecord.magic != BP_MAGIC){
+        BIOPutStrg("No boot profile recorded.");
+        BIOOutCRLF();
+    }else{
+        BIOPutStrg("Boot phase            cycles        us");
+        BIOOutCRLF();
+        for(i = BP_SYSINIT; i < BP_NUM_MARKS; i++){
+            BIOPutStrg(bpNames[i]);
+            col = 0;
+            while(bpNames[i][col] != '\0'){
+                col++;
+            }
+            while(col < BP_NAME_COL){
+                BIOWrite(' ');
+                col++;
+            }
+            if(bpRecord.stamp[i] == 0){
+                BIOPutStrg("         -");
+            }else{
+                cycles = bpRecord.stamp[i] - last;
+                last = bpRecord.stamp[i];
+                if(i <= BP_CLOCK){
+                    hz = BP_RESET_CLK_HZ;
+                }else{
+                    hz = SystemCoreClock;
+                }
+                BIOOutDecWord(cycles, 10U);
+                BIOWrite(' ');
+                BIOOutDecWord((INT32U)(((INT64U)cycles * 1000000U)/hz), 9U);
+                total_us += (INT32U)(((INT64U)cycles * 1000000U)/hz);
+            }
+            BIOOutCRLF();
+        }
+        BIOPutStrg("Total                 ");
+        BIOOutDecWord(last, 10U);
+        BIOWrite(' ');
+        BIOOutDecWord(total_us, 9U);
+        BIOOutCRLF();
+    }
+}
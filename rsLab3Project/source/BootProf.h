@@ -0,0 +1,46 @@
+/****************************************************************************************
+* BootProf.h - Boot phase profiler.
+*
+*   Records a DWT cycle counter time stamp at the end of each startup phase, from
+*   the first instruction of ResetISR to the first user prompt. The record is kept
+*   in a no-init RAM section so it is not touched by data_init()/bss_init(), which
+*   run while it is being filled.
+*
+****************************************************************************************/
+#ifndef BP_INCL
+#define BP_INCL
+
+/****************************************************************************************
+* Boot phases - BootProfMark() is called at the end of each one
+****************************************************************************************/
+#define BP_RESET        0U      /* ResetISR entry, time zero */
+#define BP_SYSINIT      1U      /* SystemInit(), watchdog off */
+#define BP_DATA         2U      /* data_init() for all RW sections */
+#define BP_BSS          3U      /* bss_init() for all BSS sections */
+#define BP_MAIN         4U      /* FPU, VTOR and library init up to main() */
+#define BP_CLOCK        5U      /* K65TWR_BootClock() */
+#define BP_BIOOPEN      6U      /* BIOOpen() */
+#define BP_CHKSUM       7U      /* Boot checksum */
+#define BP_PROMPT       8U      /* Counter start and first prompt */
+#define BP_NUM_MARKS    9U
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* BootProfStart() - Starts the DWT cycle counter from zero and clears the record.
+*                   Must be the first call in ResetISR. Uses no initialized data.
+****************************************************************************************/
+void BootProfStart(void);
+
+/****************************************************************************************
+* BootProfMark() - Stamps the end of a boot phase. Uses no initialized data.
+****************************************************************************************/
+void BootProfMark(INT8U phase);
+
+/****************************************************************************************
+* BootProfOut() - Outputs each phase's duration in core cycles and microseconds.
+****************************************************************************************/
+void BootProfOut(void);
+
+#endif
@@ -0,0 +1,896 @@
+/****************************************************************************************
+* ChkSum.c - Memory checksums for rsLab3Project.
+*
+*   The boot checksum is the low 16 bits of the sum of every byte in a block.
+*
+*   Algorithm registry: csAlgTbl has a software and an optional CRC0 kernel for
+*   each algorithm. The CRCs use 256 entry tables built on first use. The sums
+*   defer their modulo for as many bytes as cannot overflow 32 bits, and Sum16
+*   adds a word at a time in two 16-bit byte lanes. CRC0 is fed aligned words
+*   with byte writes for the ends and its transpose settings do the bit and
+*   byte reflection that CRC-32 needs.
+*
+*   Erased sector skip: a flash sector that reads all 0xFF words contributes a
+*   known amount to the sums, so kernels with a fill function add it in closed
+*   form instead of byte by byte. Only whole sectors inside the range are
+*   checked. The CRCs have no fill function and always scan every byte.
+*
+*   Cached boot checksum: the flash only changes when the board is reflashed, so
+*   the result of the boot scan is kept in the VBAT register file together with
+*   a build identifier and the address range. The register file survives resets
+*   as long as VBAT is powered. The build identifier comes from the GNU build
+*   ID note the linker stamps into the image (-Wl,--build-id), so it changes
+*   with every link that changes the output and not with the flash contents.
+*   A corrupted image then still finds its cached value and fails the
+*   background rescan that always follows. The mismatch stays latched in the
+*   register file, and every later boot reports it again until CsCacheClear().
+*   Without the note the cache is not used.
+*
+* Robert Sanborn, 10/29/2018
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "MK65F18_features.h"
+#include "BasicIO.h"
+#include "TimeStamp.h"
+#include "ChkSum.h"
+
+#define CS_CACHE_MAGIC      0x43534348U     /* "CSCH" */
+#define CS_ALERT_MAGIC      0x4353414CU     /* "CSAL", the rescan did not match */
+#define CS_NOTE_GNU         0x00554E47U     /* "GNU" */
+#define CS_NOTE_BUILD_ID    3U              /* NT_GNU_BUILD_ID */
+#define CS_NOTE_NAME_WORDS  1U
+#define CS_VERIFY_STEP      1024U           /* Bytes summed per CsVerifyTask() */
+
+#define CS_SUM16_LANE_WORDS 128U            /* Words before a 16-bit byte lane can carry */
+#define CS_FLETCHER_WORDS   359U            /* Words before Fletcher-32 sums can overflow */
+#define CS_FLETCHER_MOD     65535U
+#define CS_ADLER_BYTES      5552U           /* Bytes before Adler-32 sums can overflow */
+#define CS_ADLER_MOD        65521U
+#define CS_CRC16_POLY       0x1021U
+#define CS_CRC16_INIT       0xFFFFU
+#define CS_CRC32_POLY       0xEDB88320U     /* Reflected 0x04C11DB7 */
+#define CS_CRC32_POLY_HW    0x04C11DB7U
+#define CS_CRC32_INIT       0xFFFFFFFFU
+
+/* CRC0 CTRL transpose types */
+#define CS_TOT_NONE         0U
+#define CS_TOT_BITS_BYTES   2U
+#define CS_TOT_BYTES        3U
+
+#define CS_SECTOR_BYTES     FSL_FEATURE_FLASH_PFLASH_BLOCK_SECTOR_SIZE
+#define CS_ERASED_WORD      0xFFFFFFFFU
+#define CS_ERASED_BYTE      0xFFU
+
+#define CS_BENCH_ADDR       0x00000000U     /* Flash */
+#define CS_BENCH_BYTES      0x00010000U
+
+/* VBAT register file layout */
+#define CS_REG_MAGIC        0U
+#define CS_REG_BUILD        1U
+#define CS_REG_LOW          2U
+#define CS_REG_HIGH         3U
+#define CS_REG_SUM          4U              /* sum in low half, ~sum in high half */
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+extern unsigned int _image_start;               /* Linker generated, first flash byte */
+extern unsigned int _image_end;                 /* of the image and one past the last */
+/* Linker script symbol at the .note.gnu.build-id section, weak so a link
+ * without it still builds: namesz, descsz, type, "GNU", then the ID */
+extern const INT32U _build_id_note[] __attribute__ ((weak));
+
+/* One way of computing an algorithm */
+typedef struct cs_kernel{
+    void (*init)(CS_CTX *ctx);
+    void (*update)(CS_CTX *ctx, const INT8U *data, INT32U len);
+    INT32U (*final)(CS_CTX *ctx);
+    void (*fill)(CS_CTX *ctx, INT8U byte, INT32U len);     /* len copies of byte, or 0 */
+}CS_KERNEL;
+
+typedef struct{
+    const INT8C *name;
+    INT8U digits;
+    const CS_KERNEL *kern[CS_NUM_KERN];     /* 0 if there is no such kernel */
+}CS_ALG;
+
+static INT32U csBuildId(void);
+static void csOutMBps(INT32U bytes, INT32U cycles);
+static INT8U csErased(INT32U addr, INT32U len);
+
+static void csSumInit(CS_CTX *ctx);
+static void csSum16Update(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csSum16Final(CS_CTX *ctx);
+static void csSum16Fill(CS_CTX *ctx, INT8U byte, INT32U len);
+static void csFletcherUpdate(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csFletcherFinal(CS_CTX *ctx);
+static void csFletcherFill(CS_CTX *ctx, INT8U byte, INT32U len);
+static void csAdlerInit(CS_CTX *ctx);
+static void csAdlerUpdate(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csAdlerFinal(CS_CTX *ctx);
+static void csAdlerFill(CS_CTX *ctx, INT8U byte, INT32U len);
+static void csCrc16Init(CS_CTX *ctx);
+static void csCrc16Update(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csCrc16Final(CS_CTX *ctx);
+static void csCrc32Init(CS_CTX *ctx);
+static void csCrc32Update(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csCrc32Final(CS_CTX *ctx);
+static void csCrc0Start(INT32U ctrl, INT32U poly, INT32U seed);
+static void csCrc16HwInit(CS_CTX *ctx);
+static void csCrc32HwInit(CS_CTX *ctx);
+static void csCrc0Update(CS_CTX *ctx, const INT8U *data, INT32U len);
+static INT32U csCrc16HwFinal(CS_CTX *ctx);
+static INT32U csCrc32HwFinal(CS_CTX *ctx);
+
+static const CS_KERNEL csSum16Sw = {csSumInit, csSum16Update, csSum16Final, csSum16Fill};
+static const CS_KERNEL csFletcherSw = {csSumInit, csFletcherUpdate, csFletcherFinal, csFletcherFill};
+static const CS_KERNEL csAdlerSw = {csAdlerInit, csAdlerUpdate, csAdlerFinal, csAdlerFill};
+static const CS_KERNEL csCrc16Sw = {csCrc16Init, csCrc16Update, csCrc16Final, 0};
+static const CS_KERNEL csCrc32Sw = {csCrc32Init, csCrc32Update, csCrc32Final, 0};
+static const CS_KERNEL csCrc16Hw = {csCrc16HwInit, csCrc0Update, csCrc16HwFinal, 0};
+static const CS_KERNEL csCrc32Hw = {csCrc32HwInit, csCrc0Update, csCrc32HwFinal, 0};
+
+static const CS_ALG csAlgTbl[CS_NUM_ALG] = {
+    {"sum16",      4U, {&csSum16Sw,    0}},
+    {"fletcher32", 8U, {&csFletcherSw, 0}},
+    {"adler32",    8U, {&csAdlerSw,    0}},
+    {"crc16",      4U, {&csCrc16Sw,    &csCrc16Hw}},
+    {"crc32",      8U, {&csCrc32Sw,    &csCrc32Hw}},
+};
+
+static INT16U csCrc16Tbl[256];
+static INT32U csCrc32Tbl[256];
+static INT8U csCrcTblReady = FALSE;
+static INT32U csSkipped;                /* Bytes skipped by the last CsCalcSkip() */
+
+static CS_JOB csVerifyJob;
+static INT16U csVerifyExpect;
+static INT8U csVerifyOn = FALSE;
+
+/**********************************************************************************
+* CalcChkSum() -ascertains checksum for memory block indicated by starting and
+*               ending addresses
+*
+* Description:  Loads every byte from starting address to ending address
+*               and takes the first 16 bits of the sum of all said bytes.
+*               Note that it if starting address is greater than ending address
+*               function will only return byte stored at ending address.
+*
+* Return Value: c_sum, 16 bit unsigned integer, the first 16 bits of the sum
+*               of all bytes between the two addresses
+*
+* Arguments:    startaddr is pointer to the initial address of the memory block
+*               endaddr is the pointer to the last address of the memory block
+**********************************************************************************/
+INT16U CalcChkSum(INT8U *startaddr, INT8U *endaddr){
+    INT16U c_sum = 0;
+    INT8U membyte;
+    INT8U *addr = startaddr;
+
+    /*Iterate over all memory locations from start address to address
+     * right before ending address and sum up all bytes*/
+    while(addr < endaddr){
+        membyte = *addr;
+        addr++;
+        c_sum += (INT16U)membyte;
+    }
+    c_sum += ( (INT16U)(*endaddr) );
+
+    return c_sum;
+}
+
+/****************************************************************************************
+* CsStart() - Starts a calculation of alg with kern.
+*    return: 0 if started, 1 if alg has no such kernel
+****************************************************************************************/
+INT8U CsStart(CS_CTX *ctx, INT8U alg, INT8U kern){
+    INT8U rval;
+    if(CsHasKern(alg, kern) == FALSE){
+        rval = 1U;
+    }else{
+        ctx->kern = csAlgTbl[alg].kern[kern];
+        ctx->odd = FALSE;
+        ctx->kern->init(ctx);
+        rval = 0U;
+    }
+    return rval;
+}
+
+/****************************************************************************************
+* CsUpdate() - Adds len bytes at data to a calculation.
+****************************************************************************************/
+void CsUpdate(CS_CTX *ctx, const INT8U *data, INT32U len){
+    ctx->kern->update(ctx, data, len);
+}
+
+/****************************************************************************************
+* CsFinish() - Ends a calculation.
+*    return: the checksum, CsAlgDigits() hex digits wide
+****************************************************************************************/
+INT32U CsFinish(CS_CTX *ctx){
+    return ctx->kern->final(ctx);
+}
+
+/****************************************************************************************
+* CsCalc() - Checksum of lowaddr through highaddr, inclusive, with alg and kern.
+*            Uses the software kernel if alg has no kern kernel.
+****************************************************************************************/
+INT32U CsCalc(INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr){
+    CS_CTX ctx;
+    if(CsStart(&ctx, alg, kern) != 0){
+        (void)CsStart(&ctx, alg, CS_KERN_SW);
+    }else{
+    }
+    /* Two updates so the whole 4GB space cannot overflow the length */
+    CsUpdate(&ctx, (const INT8U *)lowaddr, highaddr - lowaddr);
+    CsUpdate(&ctx, (const INT8U *)highaddr, 1U);
+    return CsFinish(&ctx);
+}
+
+/****************************************************************************************
+* CsRangeStart() - Sets up a calculation of lowaddr through highaddr, inclusive,
+*                  with alg and kern. Uses the software kernel if alg has no kern
+*                  kernel. skip is TRUE to account for erased sectors without
+*                  summing them.
+****************************************************************************************/
+void CsRangeStart(CS_RANGE *rng, INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr,
+                  INT8U skip){
+    if(CsStart(&rng->ctx, alg, kern) != 0){
+        (void)CsStart(&rng->ctx, alg, CS_KERN_SW);
+    }else{
+    }
+    rng->addr = lowaddr;
+    rng->left = ((INT64U)highaddr - lowaddr) + 1U;
+    rng->skipped = 0;
+    rng->skip = skip;
+}
+
+/****************************************************************************************
+* CsRangeStep() - Handles at least maxbytes more bytes of the range, rounded up to
+*                 a sector boundary.
+*    return: TRUE when the range is done, CsFinish(&rng->ctx) is the result
+****************************************************************************************/
+INT8U CsRangeStep(CS_RANGE *rng, INT32U maxbytes){
+    INT32U len;
+    INT32U done = 0;
+    while((rng->left > 0) && (done < maxbytes)){
+        /* Up to the next sector boundary */
+        len = CS_SECTOR_BYTES - (rng->addr & (CS_SECTOR_BYTES - 1U));
+        if(len > rng->left){
+            len = (INT32U)rng->left;
+        }else{
+        }
+        if((rng->skip != FALSE) && (len == CS_SECTOR_BYTES) && (rng->ctx.kern->fill != 0) &&
+           (csErased(rng->addr, len) != FALSE)){
+            rng->ctx.kern->fill(&rng->ctx, CS_ERASED_BYTE, len);
+            rng->skipped += len;
+        }else{
+            CsUpdate(&rng->ctx, (const INT8U *)rng->addr, len);
+        }
+        rng->addr += len;
+        rng->left -= len;
+        done += len;
+    }
+    return (rng->left == 0) ? TRUE : FALSE;
+}
+
+/****************************************************************************************
+* CsCalcSkip() - Same result as CsCalc() but whole erased flash sectors in the
+*                range are accounted for without summing them, when the
+*                algorithm allows it.
+****************************************************************************************/
+INT32U CsCalcSkip(INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr){
+    CS_RANGE rng;
+    CsRangeStart(&rng, alg, kern, lowaddr, highaddr, TRUE);
+    while(CsRangeStep(&rng, 0xFFFFFFFFU) == FALSE){
+    }
+    csSkipped = rng.skipped;
+    return CsFinish(&rng.ctx);
+}
+
+/****************************************************************************************
+* CsSkipped() - Bytes of erased sectors the last CsCalcSkip() did not sum.
+****************************************************************************************/
+INT32U CsSkipped(void){
+    return csSkipped;
+}
+
+/****************************************************************************************
+* CsImageRange() - First and last flash address of the linked image, code and
+*                  initialized data load images included.
+****************************************************************************************/
+void CsImageRange(INT32U *lowaddr, INT32U *highaddr){
+    *lowaddr = (INT32U)&_image_start;
+    *highaddr = (INT32U)&_image_end - 1U;
+}
+
+/****************************************************************************************
+* CsAlgName() - Command line name of alg, 0 for an unknown alg.
+****************************************************************************************/
+const INT8C *CsAlgName(INT8U alg){
+    const INT8C *name = 0;
+    if(alg < CS_NUM_ALG){
+        name = csAlgTbl[alg].name;
+    }else{
+    }
+    return name;
+}
+
+/****************************************************************************************
+* CsAlgFind() - Looks a command line algorithm name up in the algorithm table.
+*    return: the CS_ALG_xxx with that name, CS_NUM_ALG if there is none
+****************************************************************************************/
+INT8U CsAlgFind(const INT8C *name){
+    INT8U alg = 0;
+    const INT8C *s1;
+    const INT8C *s2;
+    INT8U found = FALSE;
+    while((alg < CS_NUM_ALG) && (found == FALSE)){
+        s1 = name;
+        s2 = csAlgTbl[alg].name;
+        while((*s1 != '\0') && (*s1 == *s2)){
+            s1++;
+            s2++;
+        }
+        if(*s1 == *s2){
+            found = TRUE;
+        }else{
+            alg++;
+        }
+    }
+    return alg;
+}
+
+/****************************************************************************************
+* CsAlgDigits() - Number of hex digits in the result of alg, 4 or 8.
+****************************************************************************************/
+INT8U CsAlgDigits(INT8U alg){
+    INT8U digits = 4U;
+    if(alg < CS_NUM_ALG){
+        digits = csAlgTbl[alg].digits;
+    }else{
+    }
+    return digits;
+}
+
+/****************************************************************************************
+* CsHasKern() - TRUE if alg has a kern kernel.
+****************************************************************************************/
+INT8U CsHasKern(INT8U alg, INT8U kern){
+    INT8U has = FALSE;
+    if((alg < CS_NUM_ALG) && (kern < CS_NUM_KERN) && (csAlgTbl[alg].kern[kern] != 0)){
+        has = TRUE;
+    }else{
+    }
+    return has;
+}
+
+/****************************************************************************************
+* CsBench() - Times every algorithm and kernel over the same block of flash and
+*             outputs the throughput in MB/s.
+****************************************************************************************/
+void CsBench(void){
+    INT8U alg;
+    INT8U kern;
+    INT32U start;
+    INT32U cyc;
+    INT32U result;
+    INT8U i;
+
+    BIOPutStrg("Checksum MB/s over ");
+    BIOOutDecWord(CS_BENCH_BYTES, 1U);
+    BIOPutStrg(" bytes of flash");
+    BIOOutCRLF();
+    BIOPutStrg("alg          result        sw MB/s    hw MB/s");
+    BIOOutCRLF();
+    for(alg = 0; alg < CS_NUM_ALG; alg++){
+        BIOPutStrg(csAlgTbl[alg].name);
+        i = 0;
+        while(csAlgTbl[alg].name[i] != '\0'){
+            i++;
+        }
+        while(i < 12U){
+            BIOWrite(' ');
+            i++;
+        }
+        for(kern = 0; kern < CS_NUM_KERN; kern++){
+            if(CsHasKern(alg, kern) != FALSE){
+                __disable_irq();
+                start = TS_GET();
+                result = CsCalc(alg, kern, CS_BENCH_ADDR, CS_BENCH_ADDR + CS_BENCH_BYTES - 1U);
+                cyc = TS_GET() - start;
+                __enable_irq();
+                if(kern == CS_KERN_SW){
+                    BIOWrite(' ');
+                    BIOOutHexWord(result);
+                    BIOPutStrg("  ");
+                }else{
+                }
+                BIOPutStrg("  ");
+                csOutMBps(CS_BENCH_BYTES, cyc);
+            }else{
+                BIOPutStrg("          -");
+            }
+        }
+        BIOOutCRLF();
+    }
+}
+
+/****************************************************************************************
+* CsJobStart() - Sets up job to checksum lowaddr through highaddr, inclusive.
+****************************************************************************************/
+void CsJobStart(CS_JOB *job, INT32U lowaddr, INT32U highaddr){
+    job->addr = (const INT8U *)lowaddr;
+    job->end = (const INT8U *)highaddr;
+    job->sum = 0;
+    job->done = FALSE;
+}
+
+/****************************************************************************************
+* CsJobStep() - Adds at most maxbytes more bytes to the job's sum. Gives the same
+*               result as CalcChkSum(), including when lowaddr > highaddr.
+*    return: TRUE when the whole block has been summed, job->sum is the result
+****************************************************************************************/
+INT8U CsJobStep(CS_JOB *job, INT32U maxbytes){
+    INT32U cnt = maxbytes;
+    const INT8U *addr = job->addr;
+    INT16U sum = job->sum;
+
+    if(job->done == FALSE){
+        while((addr < job->end) && (cnt > 0)){
+            sum += (INT16U)(*addr);
+            addr++;
+            cnt--;
+        }
+        if((addr >= job->end) && (cnt > 0)){
+            sum += (INT16U)(*job->end);
+            job->done = TRUE;
+        }else{
+        }
+        job->addr = addr;
+        job->sum = sum;
+    }else{
+    }
+    return job->done;
+}
+
+/****************************************************************************************
+* CsCacheGet() - Looks for a cached checksum of lowaddr through highaddr made by
+*                this build.
+*    return: TRUE and *sum set if found, FALSE if not
+****************************************************************************************/
+INT8U CsCacheGet(INT32U lowaddr, INT32U highaddr, INT16U *sum){
+    INT8U found = FALSE;
+    INT32U sumreg;
+    SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;       /* VBAT domain access */
+    sumreg = RFVBAT->REG[CS_REG_SUM];
+    if((RFVBAT->REG[CS_REG_MAGIC] == CS_CACHE_MAGIC) && (csBuildId() != 0) &&
+       (RFVBAT->REG[CS_REG_BUILD] == csBuildId()) &&
+       (RFVBAT->REG[CS_REG_LOW] == lowaddr) &&
+       (RFVBAT->REG[CS_REG_HIGH] == highaddr) &&
+       ((sumreg >> 16) == ((~sumreg) & 0xFFFFU))){
+        *sum = (INT16U)sumreg;
+        found = TRUE;
+    }else{
+    }
+    return found;
+}
+
+/****************************************************************************************
+* CsCachePut() - Caches the checksum of lowaddr through highaddr for this build.
+*                Does nothing while a mismatch is latched or without a build ID.
+****************************************************************************************/
+void CsCachePut(INT32U lowaddr, INT32U highaddr, INT16U sum){
+    SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;
+    if((RFVBAT->REG[CS_REG_MAGIC] != CS_ALERT_MAGIC) && (csBuildId() != 0)){
+        RFVBAT->REG[CS_REG_MAGIC] = 0;      /* Invalid while being written */
+        RFVBAT->REG[CS_REG_BUILD] = csBuildId();
+        RFVBAT->REG[CS_REG_LOW] = lowaddr;
+        RFVBAT->REG[CS_REG_HIGH] = highaddr;
+        RFVBAT->REG[CS_REG_SUM] = (INT32U)sum | ((~(INT32U)sum) << 16);
+        RFVBAT->REG[CS_REG_MAGIC] = CS_CACHE_MAGIC;
+    }else{
+    }
+}
+
+/****************************************************************************************
+* CsCacheAlert() - Looks for a mismatch latched by CsVerifyTask().
+*    return: TRUE and *sum set to the value that was expected if there is one
+****************************************************************************************/
+INT8U CsCacheAlert(INT16U *sum){
+    INT8U latched = FALSE;
+    SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;
+    if(RFVBAT->REG[CS_REG_MAGIC] == CS_ALERT_MAGIC){
+        *sum = (INT16U)RFVBAT->REG[CS_REG_SUM];
+        latched = TRUE;
+    }else{
+    }
+    return latched;
+}
+
+/****************************************************************************************
+* CsCacheClear() - Invalidates the cached checksum and a latched mismatch.
+****************************************************************************************/
+void CsCacheClear(void){
+    SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;
+    RFVBAT->REG[CS_REG_MAGIC] = 0;
+}
+
+/****************************************************************************************
+* CsVerifyStart() - Starts a background rescan of lowaddr through highaddr that
+*                   is expected to sum to expected.
+****************************************************************************************/
+void CsVerifyStart(INT32U lowaddr, INT32U highaddr, INT16U expected){
+    CsJobStart(&csVerifyJob, lowaddr, highaddr);
+    csVerifyExpect = expected;
+    csVerifyOn = TRUE;
+}
+
+/****************************************************************************************
+* CsVerifyTask() - Runs the next step of the background rescan. Call once per
+*                  main loop pass. A mismatch is latched for CsCacheAlert() and
+*                  the expected value kept, the value found is not cached.
+*    return: CS_VERIFY_IDLE, CS_VERIFY_BUSY, CS_VERIFY_OK or CS_VERIFY_FAIL
+*    *sum is set to the value found when CS_VERIFY_OK or CS_VERIFY_FAIL
+****************************************************************************************/
+INT8U CsVerifyTask(INT16U *sum){
+    INT8U rval;
+    if(csVerifyOn == FALSE){
+        rval = CS_VERIFY_IDLE;
+    }else if(CsJobStep(&csVerifyJob, CS_VERIFY_STEP) == FALSE){
+        rval = CS_VERIFY_BUSY;
+    }else{
+        csVerifyOn = FALSE;
+        *sum = csVerifyJob.sum;
+        if(csVerifyJob.sum == csVerifyExpect){
+            rval = CS_VERIFY_OK;
+        }else{
+            rval = CS_VERIFY_FAIL;
+            SIM->SCGC6 |= SIM_SCGC6_RTC_MASK;
+            RFVBAT->REG[CS_REG_MAGIC] = CS_ALERT_MAGIC;
+        }
+    }
+    return rval;
+}
+
+/****************************************************************************************
+* csBuildId() - Identifier for the running build, the words of the GNU build ID
+*               exclusive ORed together. Private.
+*    return: 0 if the linker script does not provide _build_id_note
+****************************************************************************************/
+static INT32U csBuildId(void){
+    const INT32U *note = _build_id_note;
+    INT32U id = 0;
+    INT32U i;
+    if((note != 0) && (note[0] == (CS_NOTE_NAME_WORDS * 4U)) &&
+       (note[2] == CS_NOTE_BUILD_ID) && (note[3] == CS_NOTE_GNU)){
+        for(i = 0; i < (note[1] / 4U); i++){
+            id ^= note[4U + i];
+        }
+    }else{
+    }
+    return id;
+}
+
+/****************************************************************************************
+* csOutMBps() - Outputs bytes per cycles as MB/s with two decimals, 9 characters
+*               wide. Private.
+****************************************************************************************/
+static void csOutMBps(INT32U bytes, INT32U cycles){
+    INT32U hundredths = 0;
+    INT32U lim;
+    if(cycles != 0){
+        hundredths = (INT32U)(((INT64U)bytes * SystemCoreClock) / ((INT64U)cycles * 10000U));
+    }else{
+    }
+    for(lim = 100000U; lim > 1U; lim /= 10U){
+        if((hundredths / 100U) < lim){
+            BIOWrite(' ');
+        }else{
+        }
+    }
+    BIOOutDecWord(hundredths / 100U, 1U);
+    BIOWrite('.');
+    BIOOutDecWord(hundredths % 100U, 2U);
+}
+
+/****************************************************************************************
+* csErased() - TRUE if every word of the len bytes at addr reads erased. Stops
+*              at the first programmed word. addr must be word aligned. Private.
+****************************************************************************************/
+static INT8U csErased(INT32U addr, INT32U len){
+    const INT32U *wp = (const INT32U *)addr;
+    INT32U words = len >> 2;
+    while((words > 0) && (*wp == CS_ERASED_WORD)){
+        wp++;
+        words--;
+    }
+    return (words == 0) ? TRUE : FALSE;
+}
+
+/****************************************************************************************
+* Software kernels. Private.
+****************************************************************************************/
+static void csSumInit(CS_CTX *ctx){
+    ctx->a = 0;
+    ctx->b = 0;
+}
+
+/* Bytes are added a word at a time into two 16-bit lanes, even and odd bytes.
+ * The lanes are folded into the sum before either can carry. */
+static void csSum16Update(CS_CTX *ctx, const INT8U *data, INT32U len){
+    INT32U sum = ctx->a;
+    INT32U lanes;
+    INT32U word;
+    INT32U blk;
+    const INT32U *wp;
+
+    while((len > 0) && (((INT32U)data & 3U) != 0)){
+        sum += *data;
+        data++;
+        len--;
+    }
+    while(len >= 4U){
+        blk = len >> 2;
+        if(blk > CS_SUM16_LANE_WORDS){
+            blk = CS_SUM16_LANE_WORDS;
+        }else{
+        }
+        len -= blk << 2;
+        wp = (const INT32U *)data;
+        data += blk << 2;
+        lanes = 0;
+        while(blk > 0){
+            word = *wp;
+            wp++;
+            lanes += (word & 0x00FF00FFU) + ((word >> 8) & 0x00FF00FFU);
+            blk--;
+        }
+        sum += (lanes & 0xFFFFU) + (lanes >> 16);
+    }
+    while(len > 0){
+        sum += *data;
+        data++;
+        len--;
+    }
+    ctx->a = sum;
+}
+
+static INT32U csSum16Final(CS_CTX *ctx){
+    return ctx->a & 0xFFFFU;
+}
+
+static void csSum16Fill(CS_CTX *ctx, INT8U byte, INT32U len){
+    ctx->a += (INT32U)byte * len;
+}
+
+static void csFletcherUpdate(CS_CTX *ctx, const INT8U *data, INT32U len){
+    INT32U a = ctx->a;
+    INT32U b = ctx->b;
+    INT32U blk;
+
+    if((ctx->odd != FALSE) && (len > 0)){
+        a += (INT32U)ctx->oddbyte | ((INT32U)*data << 8);
+        b += a;
+        data++;
+        len--;
+        ctx->odd = FALSE;
+    }else{
+    }
+    while(len >= 2U){
+        blk = len >> 1;
+        if(blk > CS_FLETCHER_WORDS){
+            blk = CS_FLETCHER_WORDS;
+        }else{
+        }
+        len -= blk << 1;
+        while(blk > 0){
+            a += (INT32U)data[0] | ((INT32U)data[1] << 8);
+            b += a;
+            data += 2;
+            blk--;
+        }
+        a = (a & 0xFFFFU) + (a >> 16);
+        a = (a & 0xFFFFU) + (a >> 16);
+        b = (b & 0xFFFFU) + (b >> 16);
+        b = (b & 0xFFFFU) + (b >> 16);
+    }
+    if(len > 0){
+        ctx->odd = TRUE;
+        ctx->oddbyte = *data;
+    }else{
+    }
+    ctx->a = a;
+    ctx->b = b;
+}
+
+static INT32U csFletcherFinal(CS_CTX *ctx){
+    INT32U a = ctx->a;
+    INT32U b = ctx->b;
+    if(ctx->odd != FALSE){
+        a += ctx->oddbyte;
+        b += a;
+    }else{
+    }
+    a %= CS_FLETCHER_MOD;
+    b %= CS_FLETCHER_MOD;
+    return (b << 16) | a;
+}
+
+/* n equal words w: a grows by n*w, b by n*a + w*n(n+1)/2 */
+static void csFletcherFill(CS_CTX *ctx, INT8U byte, INT32U len){
+    INT64U word = (INT64U)byte | ((INT64U)byte << 8);
+    INT64U n;
+    INT64U a;
+    INT64U b;
+    if((ctx->odd != FALSE) && (len > 0)){
+        csFletcherUpdate(ctx, &byte, 1U);
+        len--;
+    }else{
+    }
+    n = len >> 1;
+    a = ctx->a % CS_FLETCHER_MOD;
+    b = ctx->b % CS_FLETCHER_MOD;
+    b = (b + ((n * a) % CS_FLETCHER_MOD) + ((word * (((n * (n + 1U)) >> 1) % CS_FLETCHER_MOD)) % CS_FLETCHER_MOD)) % CS_FLETCHER_MOD;
+    a = (a + ((n * word) % CS_FLETCHER_MOD)) % CS_FLETCHER_MOD;
+    ctx->a = (INT32U)a;
+    ctx->b = (INT32U)b;
+    if((len & 1U) != 0){
+        ctx->odd = TRUE;
+        ctx->oddbyte = byte;
+    }else{
+    }
+}
+
+static void csAdlerInit(CS_CTX *ctx){
+    ctx->a = 1U;
+    ctx->b = 0;
+}
+
+static void csAdlerUpdate(CS_CTX *ctx, const INT8U *data, INT32U len){
+    INT32U a = ctx->a;
+    INT32U b = ctx->b;
+    INT32U blk;
+    while(len > 0){
+        blk = len;
+        if(blk > CS_ADLER_BYTES){
+            blk = CS_ADLER_BYTES;
+        }else{
+        }
+        len -= blk;
+        while(blk > 0){
+            a += *data;
+            b += a;
+            data++;
+            blk--;
+        }
+        a %= CS_ADLER_MOD;
+        b %= CS_ADLER_MOD;
+    }
+    ctx->a = a;
+    ctx->b = b;
+}
+
+static INT32U csAdlerFinal(CS_CTX *ctx){
+    return (ctx->b << 16) | ctx->a;
+}
+
+/* Same closed form as Fletcher-32 with bytes instead of words */
+static void csAdlerFill(CS_CTX *ctx, INT8U byte, INT32U len){
+    INT64U n = len;
+    INT64U a = ctx->a;
+    INT64U b = ctx->b;
+    b = (b + ((n * a) % CS_ADLER_MOD) + ((byte * (((n * (n + 1U)) >> 1) % CS_ADLER_MOD)) % CS_ADLER_MOD)) % CS_ADLER_MOD;
+    a = (a + ((n * byte) % CS_ADLER_MOD)) % CS_ADLER_MOD;
+    ctx->a = (INT32U)a;
+    ctx->b = (INT32U)b;
+}
+
+/* Builds both CRC tables the first time a CRC is started */
+static void csCrc16Init(CS_CTX *ctx){
+    INT32U i;
+    INT8U bit;
+    INT32U c16;
+    INT32U c32;
+    if(csCrcTblReady == FALSE){
+        for(i = 0; i < 256U; i++){
+            c16 = i << 8;
+            c32 = i;
+            for(bit = 0; bit < 8U; bit++){
+                c16 = ((c16 & 0x8000U) != 0) ? ((c16 << 1) ^ CS_CRC16_POLY) : (c16 << 1);
+                c32 = ((c32 & 1U) != 0) ? ((c32 >> 1) ^ CS_CRC32_POLY) : (c32 >> 1);
+            }
+            csCrc16Tbl[i] = (INT16U)c16;
+            csCrc32Tbl[i] = c32;
+        }
+        csCrcTblReady = TRUE;
+    }else{
+    }
+    ctx->a = CS_CRC16_INIT;
+}
+
+static void csCrc16Update(CS_CTX *ctx, const INT8U *data, INT32U len){
+    INT32U crc = ctx->a;
+    while(len > 0){
+        crc = ((crc << 8) & 0xFFFFU) ^ csCrc16Tbl[((crc >> 8) ^ *data) & 0xFFU];
+        data++;
+        len--;
+    }
+    ctx->a = crc;
+}
+
+static INT32U csCrc16Final(CS_CTX *ctx){
+    return ctx->a;
+}
+
+static void csCrc32Init(CS_CTX *ctx){
+    csCrc16Init(ctx);
+    ctx->a = CS_CRC32_INIT;
+}
+
+static void csCrc32Update(CS_CTX *ctx, const INT8U *data, INT32U len){
+    INT32U crc = ctx->a;
+    while(len > 0){
+        crc = (crc >> 8) ^ csCrc32Tbl[(crc ^ *data) & 0xFFU];
+        data++;
+        len--;
+    }
+    ctx->a = crc;
+}
+
+static INT32U csCrc32Final(CS_CTX *ctx){
+    return ~ctx->a;
+}
+
+/****************************************************************************************
+* CRC0 hardware kernels. Private.
+****************************************************************************************/
+/* Sets the protocol and polynomial then loads the seed with WAS set */
+static void csCrc0Start(INT32U ctrl, INT32U poly, INT32U seed){
+    SIM->SCGC6 |= SIM_SCGC6_CRC_MASK;
+    CRC0->CTRL = ctrl;
+    CRC0->GPOLY = poly;
+    CRC0->CTRL = ctrl | CRC_CTRL_WAS_MASK;
+    CRC0->DATA = seed;
+    CRC0->CTRL = ctrl;
+}
+
+static void csCrc16HwInit(CS_CTX *ctx){
+    csCrc0Start(CRC_CTRL_TOT(CS_TOT_BYTES) | CRC_CTRL_TOTR(CS_TOT_NONE),
+                CS_CRC16_POLY, CS_CRC16_INIT);
+}
+
+static void csCrc32HwInit(CS_CTX *ctx){
+    csCrc0Start(CRC_CTRL_TOT(CS_TOT_BITS_BYTES) | CRC_CTRL_TOTR(CS_TOT_BITS_BYTES) |
+                CRC_CTRL_FXOR_MASK | CRC_CTRL_TCRC_MASK, CS_CRC32_POLY_HW, CS_CRC32_INIT);
+}
+
+static void csCrc0Update(CS_CTX *ctx, const INT8U *data, INT32U len){
+    const INT32U *wp;
+    while((len > 0) && (((INT32U)data & 3U) != 0)){
+        CRC0->ACCESS8BIT.DATALL = *data;
+        data++;
+        len--;
+    }
+    wp = (const INT32U *)data;
+    while(len >= 4U){
+        CRC0->DATA = *wp;
+        wp++;
+        len -= 4U;
+    }
+    data = (const INT8U *)wp;
+    while(len > 0){
+        CRC0->ACCESS8BIT.DATALL = *data;
+        data++;
+        len--;
+    }
+}
+
+static INT32U csCrc16HwFinal(CS_CTX *ctx){
+    return CRC0->DATA & 0xFFFFU;
+}
+
+static INT32U csCrc32HwFinal(CS_CTX *ctx){
+    return CRC0->DATA;
+}
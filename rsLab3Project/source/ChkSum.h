@@ -0,0 +1,224 @@
+/****************************************************************************************
+* ChkSum.h - Memory checksums for rsLab3Project.
+*
+*   The boot checksum is the low 16 bits of the sum of every byte in a block.
+*   Besides the blocking CalcChkSum() a checksum can be run as a job in small
+*   steps from the main loop, and the boot checksum can be cached in the VBAT
+*   register file keyed by a build identifier so it is not rescanned on every
+*   reset.
+*
+*   Other algorithms are reached through a registry indexed by CS_ALG_xxx. Each
+*   algorithm has a software kernel and, for the CRCs, a CRC0 hardware kernel.
+*   A calculation is CsStart(), any number of CsUpdate() calls, then
+*   CsFinish(). Only one hardware calculation may be in progress at a time.
+*
+****************************************************************************************/
+#ifndef CS_INCL
+#define CS_INCL
+
+/****************************************************************************************
+* Algorithms - used as an index for the registry
+****************************************************************************************/
+#define CS_ALG_SUM16        0U      /* Truncated byte sum, same as CalcChkSum() */
+#define CS_ALG_FLETCHER32   1U      /* Little endian 16-bit words, odd byte zero padded */
+#define CS_ALG_ADLER32      2U
+#define CS_ALG_CRC16        3U      /* CRC-16/CCITT-FALSE, 0x1021 init 0xFFFF */
+#define CS_ALG_CRC32        4U      /* CRC-32 as used by zip and ethernet */
+#define CS_NUM_ALG          5U
+
+/* Kernels */
+#define CS_KERN_SW          0U      /* CPU */
+#define CS_KERN_HW          1U      /* CRC0 module */
+#define CS_NUM_KERN         2U
+
+/****************************************************************************************
+* Types
+****************************************************************************************/
+struct cs_kernel;
+
+/* State of one calculation, only used through CsStart/CsUpdate/CsFinish */
+typedef struct{
+    const struct cs_kernel *kern;
+    INT32U a;
+    INT32U b;
+    INT8U odd;                      /* Fletcher-32 has a byte waiting for its pair */
+    INT8U oddbyte;
+}CS_CTX;
+
+typedef struct{
+    const INT8U *addr;              /* Next byte to add */
+    const INT8U *end;               /* Last byte of the block */
+    INT16U sum;
+    INT8U done;
+}CS_JOB;
+
+/* Range calculation that can be run in steps */
+typedef struct{
+    CS_CTX ctx;
+    INT32U addr;                    /* Next byte */
+    INT64U left;                    /* Bytes left, up to 4GB */
+    INT32U skipped;                 /* Erased bytes not summed */
+    INT8U skip;                     /* Skip erased sectors */
+}CS_RANGE;
+
+/* CsVerifyTask() return values */
+#define CS_VERIFY_IDLE      0U      /* No verify running */
+#define CS_VERIFY_BUSY      1U
+#define CS_VERIFY_OK        2U      /* Finished and matched, reported once */
+#define CS_VERIFY_FAIL      3U      /* Finished and did not match, reported once */
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/**********************************************************************************
+* CalcChkSum() -ascertains checksum for memory block indicated by starting and
+*               ending addresses
+*
+* Description:  Loads every byte from starting address to ending address
+*               and takes the first 16 bits of the sum of all said bytes.
+*               Note that it if starting address is greater than ending address
+*               function will only return byte stored at ending address.
+*
+* Return Value: c_sum, 16 bit unsigned integer, the first 16 bits of the sum
+*               of all bytes between the two addresses
+*
+* Arguments:    startaddr is pointer to the initial address of the memory block
+*               endaddr is the pointer to the last address of the memory block
+**********************************************************************************/
+INT16U CalcChkSum(INT8U *startaddr, INT8U *endaddr);
+
+/****************************************************************************************
+* CsStart() - Starts a calculation of alg with kern.
+*    return: 0 if started, 1 if alg has no such kernel
+****************************************************************************************/
+INT8U CsStart(CS_CTX *ctx, INT8U alg, INT8U kern);
+
+/****************************************************************************************
+* CsUpdate() - Adds len bytes at data to a calculation.
+****************************************************************************************/
+void CsUpdate(CS_CTX *ctx, const INT8U *data, INT32U len);
+
+/****************************************************************************************
+* CsFinish() - Ends a calculation.
+*    return: the checksum, CsAlgDigits() hex digits wide
+****************************************************************************************/
+INT32U CsFinish(CS_CTX *ctx);
+
+/****************************************************************************************
+* CsCalc() - Checksum of lowaddr through highaddr, inclusive, with alg and kern.
+*            Uses the software kernel if alg has no kern kernel.
+****************************************************************************************/
+INT32U CsCalc(INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr);
+
+/****************************************************************************************
+* CsRangeStart() - Sets up a calculation of lowaddr through highaddr, inclusive,
+*                  with alg and kern. Uses the software kernel if alg has no kern
+*                  kernel. skip is TRUE to account for erased sectors without
+*                  summing them.
+****************************************************************************************/
+void CsRangeStart(CS_RANGE *rng, INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr,
+                  INT8U skip);
+
+/****************************************************************************************
+* CsRangeStep() - Handles at least maxbytes more bytes of the range, rounded up to
+*                 a sector boundary.
+*    return: TRUE when the range is done, CsFinish(&rng->ctx) is the result
+****************************************************************************************/
+INT8U CsRangeStep(CS_RANGE *rng, INT32U maxbytes);
+
+/****************************************************************************************
+* CsCalcSkip() - Same result as CsCalc() but whole erased flash sectors in the
+*                range are accounted for without summing them, when the
+*                algorithm allows it.
+****************************************************************************************/
+INT32U CsCalcSkip(INT8U alg, INT8U kern, INT32U lowaddr, INT32U highaddr);
+
+/****************************************************************************************
+* CsSkipped() - Bytes of erased sectors the last CsCalcSkip() did not sum.
+****************************************************************************************/
+INT32U CsSkipped(void);
+
+/****************************************************************************************
+* CsImageRange() - First and last flash address of the linked image, code and
+*                  initialized data load images included.
+****************************************************************************************/
+void CsImageRange(INT32U *lowaddr, INT32U *highaddr);
+
+/****************************************************************************************
+* CsAlgName() - Command line name of alg, 0 for an unknown alg.
+****************************************************************************************/
+const INT8C *CsAlgName(INT8U alg);
+
+/****************************************************************************************
+* CsAlgFind() - Looks a command line algorithm name up in the algorithm table.
+*    return: the CS_ALG_xxx with that name, CS_NUM_ALG if there is none
+****************************************************************************************/
+INT8U CsAlgFind(const INT8C *name);
+
+/****************************************************************************************
+* CsAlgDigits() - Number of hex digits in the result of alg, 4 or 8.
+****************************************************************************************/
+INT8U CsAlgDigits(INT8U alg);
+
+/****************************************************************************************
+* CsHasKern() - TRUE if alg has a kern kernel.
+****************************************************************************************/
+INT8U CsHasKern(INT8U alg, INT8U kern);
+
+/****************************************************************************************
+* CsBench() - Times every algorithm and kernel over the same block of flash and
+*             outputs the throughput in MB/s.
+****************************************************************************************/
+void CsBench(void);
+
+/****************************************************************************************
+* CsJobStart() - Sets up job to checksum lowaddr through highaddr, inclusive.
+****************************************************************************************/
+void CsJobStart(CS_JOB *job, INT32U lowaddr, INT32U highaddr);
+
+/****************************************************************************************
+* CsJobStep() - Adds at most maxbytes more bytes to the job's sum.
+*    return: TRUE when the whole block has been summed, job->sum is the result
+****************************************************************************************/
+INT8U CsJobStep(CS_JOB *job, INT32U maxbytes);
+
+/****************************************************************************************
+* CsCacheGet() - Looks for a cached checksum of lowaddr through highaddr made by
+*                this build.
+*    return: TRUE and *sum set if found, FALSE if not
+****************************************************************************************/
+INT8U CsCacheGet(INT32U lowaddr, INT32U highaddr, INT16U *sum);
+
+/****************************************************************************************
+* CsCachePut() - Caches the checksum of lowaddr through highaddr for this build.
+*                Does nothing while a mismatch is latched or without a build ID.
+****************************************************************************************/
+void CsCachePut(INT32U lowaddr, INT32U highaddr, INT16U sum);
+
+/****************************************************************************************
+* CsCacheAlert() - Looks for a mismatch latched by CsVerifyTask().
+*    return: TRUE and *sum set to the value that was expected if there is one
+****************************************************************************************/
+INT8U CsCacheAlert(INT16U *sum);
+
+/****************************************************************************************
+* CsCacheClear() - Invalidates the cached checksum and a latched mismatch.
+****************************************************************************************/
+void CsCacheClear(void);
+
+/****************************************************************************************
+* CsVerifyStart() - Starts a background rescan of lowaddr through highaddr that
+*                   is expected to sum to expected.
+****************************************************************************************/
+void CsVerifyStart(INT32U lowaddr, INT32U highaddr, INT16U expected);
+
+/****************************************************************************************
+* CsVerifyTask() - Runs the next step of the background rescan. Call once per
+*                  main loop pass. A mismatch is latched for CsCacheAlert() and
+*                  the expected value kept, the value found is not cached.
+*    return: CS_VERIFY_IDLE, CS_VERIFY_BUSY, CS_VERIFY_OK or CS_VERIFY_FAIL
+*    *sum is set to the value found when CS_VERIFY_OK or CS_VERIFY_FAIL
+****************************************************************************************/
+INT8U CsVerifyTask(INT16U *sum);
+
+#endif
@@ -0,0 +1,196 @@
+/****************************************************************************************
+* CmdParse.c - Table driven command line parser.
+*
+*   A command line is a verb followed by up to CMD_MAX_ARGS arguments separated
+*   by spaces. Verbs are looked up with a binary search so the command table
+*   must be sorted in ascending character order. Decimal and hex arguments are
+*   converted with BasicIO before the handler is called.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "CmdParse.h"
+
+#define CMD_HELP_COL    24U         /* Column the help text starts in */
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static INT8S cmdStrgCmp(const INT8C *s1, const INT8C *s2);
+static INT8C *cmdNextToken(INT8C **line);
+static INT8U cmdStrgLen(const INT8C *strg);
+
+/****************************************************************************************
+* CmdExecute() - Parses a command line and calls the matching handler.
+*    Parameters: table is the sorted command table with nentries entries
+*                line is the NULL terminated command line. It is split in place.
+*                *state is set to the handler's return value if CMD_OK
+*    return: CMD_OK, CMD_EMPTY, CMD_UNKNOWN or CMD_BAD_ARGS
+****************************************************************************************/
+INT8U CmdExecute(const CMD_ENTRY *table, INT8U nentries, INT8C *line, INT8C *state){
+    CMD_ARG args[CMD_MAX_ARGS];
+    const CMD_ENTRY *entry;
+    INT8C *verb;
+    INT8C *tok;
+    INT8C *rest = line;
+    INT8U nargs = 0;
+    INT8U rval = CMD_OK;
+
+    verb = cmdNextToken(&rest);
+    if(verb == 0){
+        rval = CMD_EMPTY;
+    }else{
+        entry = CmdFind(table, nentries, verb);
+        if(entry == 0){
+            rval = CMD_UNKNOWN;
+        }else{
+            tok = cmdNextToken(&rest);
+            while((tok != 0) && (rval == CMD_OK)){
+                if((nargs >= CMD_MAX_ARGS) || (entry->argtype[nargs] == CMD_ARG_NONE)){
+                    rval = CMD_BAD_ARGS;                /* Too many arguments */
+                }else{
+                    args[nargs].strg = tok;
+                    args[nargs].num = 0;
+                    if(entry->argtype[nargs] == CMD_ARG_DEC){
+                        if(BIODecStrgtoWord(tok, &args[nargs].num) != 0){
+                            rval = CMD_BAD_ARGS;
+                        }else{
+                        }
+                    }else if(entry->argtype[nargs] == CMD_ARG_HEX){
+                        if(BIOHexStrgtoWord(tok, &args[nargs].num) != 0){
+                            rval = CMD_BAD_ARGS;
+                        }else{
+                        }
+                    }else{
+                    }
+                    nargs++;
+                    tok = cmdNextToken(&rest);
+                }
+            }
+            if(nargs < entry->minargs){
+                rval = CMD_BAD_ARGS;
+            }else{
+            }
+            if(rval == CMD_OK){
+                *state = entry->handler(args, nargs);
+            }else{
+                BIOPutStrg("Usage: ");
+                CmdUsage(entry);
+                BIOOutCRLF();
+            }
+        }
+    }
+    return rval;
+}
+
+/****************************************************************************************
+* CmdHelp() - Outputs one line per table entry: verb, usage and help text.
+****************************************************************************************/
+void CmdHelp(const CMD_ENTRY *table, INT8U nentries){
+    INT8U i;
+    INT8U col;
+    for(i = 0; i < nentries; i++){
+        CmdUsage(&table[i]);
+        col = cmdStrgLen(table[i].verb) + 1U + cmdStrgLen(table[i].usage);
+        do{
+            BIOWrite(' ');
+            col++;
+        }while(col < CMD_HELP_COL);
+        BIOPutStrg(table[i].help);
+        BIOOutCRLF();
+    }
+}
+
+/****************************************************************************************
+* CmdUsage() - Outputs the verb and usage of one entry.
+****************************************************************************************/
+void CmdUsage(const CMD_ENTRY *entry){
+    BIOPutStrg(entry->verb);
+    BIOWrite(' ');
+    BIOPutStrg(entry->usage);
+}
+
+/****************************************************************************************
+* CmdFind() - Binary search for a verb.
+*    return: pointer to the entry or 0 if not found
+****************************************************************************************/
+const CMD_ENTRY *CmdFind(const CMD_ENTRY *table, INT8U nentries, const INT8C *verb){
+    INT8U lo = 0;
+    INT8U hi = nentries;
+    INT8U mid;
+    INT8S cmp;
+    const CMD_ENTRY *found = 0;
+    while((lo < hi) && (found == 0)){
+        mid = (INT8U)((lo + hi) >> 1);
+        cmp = cmdStrgCmp(verb, table[mid].verb);
+        if(cmp == 0){
+            found = &table[mid];
+        }else if(cmp < 0){
+            hi = mid;
+        }else{
+            lo = mid + 1U;
+        }
+    }
+    return found;
+}
+
+/****************************************************************************************
+* CmdWordIndex() - Looks a CMD_ARG_STR argument up in a list of words.
+*    return: index of the matching word, nwords if there is no match
+****************************************************************************************/
+INT8U CmdWordIndex(const INT8C *strg, const INT8C *const *words, INT8U nwords){
+    INT8U i = 0;
+    while((i < nwords) && (cmdStrgCmp(strg, words[i]) != 0)){
+        i++;
+    }
+    return i;
+}
+
+/****************************************************************************************
+* cmdNextToken() - Returns the next space separated token and NULL terminates it.
+*                  *line is advanced past the token. Returns 0 at end of line.
+****************************************************************************************/
+static INT8C *cmdNextToken(INT8C **line){
+    INT8C *p = *line;
+    INT8C *tok;
+    while(*p == ' '){
+        p++;
+    }
+    if(*p == '\0'){
+        tok = 0;
+    }else{
+        tok = p;
+        while((*p != ' ') && (*p != '\0')){
+            p++;
+        }
+        if(*p == ' '){
+            *p = '\0';
+            p++;
+        }else{
+        }
+    }
+    *line = p;
+    return tok;
+}
+
+/****************************************************************************************
+* cmdStrgCmp() - Compares two strings. Returns <0, 0 or >0 like strcmp().
+****************************************************************************************/
+static INT8S cmdStrgCmp(const INT8C *s1, const INT8C *s2){
+    while((*s1 != '\0') && (*s1 == *s2)){
+        s1++;
+        s2++;
+    }
+    return (INT8S)((INT8U)*s1 > (INT8U)*s2) - (INT8S)((INT8U)*s1 < (INT8U)*s2);
+}
+
+/****************************************************************************************
+* cmdStrgLen() - Returns the length of a string.
+****************************************************************************************/
+static INT8U cmdStrgLen(const INT8C *strg){
+    INT8U len = 0;
+    while(strg[len] != '\0'){
+        len++;
+    }
+    return len;
+}
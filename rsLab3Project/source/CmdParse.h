@@ -0,0 +1,86 @@
+/****************************************************************************************
+* CmdParse.h - Table driven command line parser.
+*
+*   A command line is a verb followed by up to CMD_MAX_ARGS arguments separated
+*   by spaces. Verbs are looked up with a binary search so the command table
+*   must be sorted in ascending character order. Decimal and hex arguments are
+*   converted before the handler is called. Help text is generated from the
+*   table.
+*
+****************************************************************************************/
+#ifndef CMD_INCL
+#define CMD_INCL
+
+/****************************************************************************************
+* Defined Constants
+****************************************************************************************/
+#define CMD_LINE_LN         40U     /* Max command line length, includes NULL */
+#define CMD_MAX_ARGS        3U
+
+/* Argument types */
+#define CMD_ARG_NONE        0U      /* Unused argument slot */
+#define CMD_ARG_DEC         1U      /* Decimal number */
+#define CMD_ARG_HEX         2U      /* Hex number, no prefix */
+#define CMD_ARG_STR         3U      /* Word, left as a string */
+
+/* CmdExecute() return values */
+#define CMD_OK              0U
+#define CMD_EMPTY           1U      /* Blank line */
+#define CMD_UNKNOWN         2U      /* Verb not in table */
+#define CMD_BAD_ARGS        3U      /* Wrong number or format of arguments */
+
+/****************************************************************************************
+* Types
+****************************************************************************************/
+typedef struct{
+    INT8C *strg;                    /* Argument as typed */
+    INT32U num;                     /* Converted value for CMD_ARG_DEC/CMD_ARG_HEX */
+}CMD_ARG;
+
+/* Handler returns the program state to go to next */
+typedef INT8C (*CMD_HANDLER)(const CMD_ARG *args, INT8U nargs);
+
+typedef struct{
+    const INT8C *verb;
+    INT8U argtype[CMD_MAX_ARGS];    /* Type of each argument position */
+    INT8U minargs;                  /* Arguments after minargs are optional */
+    CMD_HANDLER handler;
+    const INT8C *usage;             /* Argument description for help */
+    const INT8C *help;              /* One line description for help */
+}CMD_ENTRY;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* CmdExecute() - Parses a command line and calls the matching handler.
+*    Parameters: table is the sorted command table with nentries entries
+*                line is the NULL terminated command line. It is split in place.
+*                *state is set to the handler's return value if CMD_OK
+*    return: CMD_OK, CMD_EMPTY, CMD_UNKNOWN or CMD_BAD_ARGS
+****************************************************************************************/
+INT8U CmdExecute(const CMD_ENTRY *table, INT8U nentries, INT8C *line, INT8C *state);
+
+/****************************************************************************************
+* CmdHelp() - Outputs one line per table entry: verb, usage and help text.
+****************************************************************************************/
+void CmdHelp(const CMD_ENTRY *table, INT8U nentries);
+
+/****************************************************************************************
+* CmdUsage() - Outputs the verb and usage of one entry.
+****************************************************************************************/
+void CmdUsage(const CMD_ENTRY *entry);
+
+/****************************************************************************************
+* CmdFind() - Binary search for a verb.
+*    return: pointer to the entry or 0 if not found
+****************************************************************************************/
+const CMD_ENTRY *CmdFind(const CMD_ENTRY *table, INT8U nentries, const INT8C *verb);
+
+/****************************************************************************************
+* CmdWordIndex() - Looks a CMD_ARG_STR argument up in a list of words.
+*    return: index of the matching word, nwords if there is no match
+****************************************************************************************/
+INT8U CmdWordIndex(const INT8C *strg, const INT8C *const *words, INT8U nwords);
+
+#endif
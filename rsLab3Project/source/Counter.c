@@ -0,0 +1,685 @@
+/****************************************************************************************
+* Counter.c - Background SW2 counting for rsLab3Project.
+*
+*   Software counter:    polls GPIOA PDIR and counts SW2 release (rising) edges.
+*   Hardware counter:    PORTA_IRQHandler counts every rising edge interrupt.
+*   Combination counter: polls the edge flag latched by hardware. Since the
+*                        interrupt is always enabled and the ISR clears ISF, the
+*                        ISR leaves a software copy of the flag for the poller.
+*                        Several edges between polls collapse into one count,
+*                        exactly like polling ISF directly.
+*
+*   Moderation:          with a holdoff set, the ISR switches SW2 from interrupt
+*                        to DMA request mode and starts PIT0. Edges during the
+*                        holdoff each trigger one minor loop of eDMA channel
+*                        CNT_DMA_CH, so they are counted by CITER instead of the
+*                        CPU. PIT0_IRQHandler() adds them to the hardware counter
+*                        and re-arms the interrupt. A holdoff that recovers edges
+*                        doubles the next one, up to CNT_MOD_MAX_SHIFT doublings.
+*
+*   ISR modes:           CntIsrMode() swaps PORTA_IRQHandler() in the RAM vector
+*                        table for a handler specialised to one job. These run
+*                        from SRAM_L and have no branches: they count the SW2 flag
+*                        bit they read from ISFR, so an entry without an edge
+*                        adds zero. Moderation only applies to CNT_ISR_FULL.
+*                        Each has a flash resident twin with the same body for
+*                        CntIsrBench().
+*
+* Robert Sanborn, 10/29/2018
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "PinCfg.h"
+#include "K65TWR_ClkCfg.h"
+#include "VecTbl.h"
+#include "RamFunc.h"
+#include "CpuLoad.h"
+#include "TimeStamp.h"
+#include "Counter.h"
+
+/* For PORTA SW2 interrupt flag*/
+#define SW2_BIT          (1U << 4U)
+#define SW2_CLR_ISF()    (PORTA->ISFR = SW2_BIT)
+#define SW2_INPUT        (GPIOA->PDIR & SW2_BIT)
+
+#define ISF_INT_REDGE      9U     /* Set ISF to rising edge with interrupt*/
+#define ISF_DMA_REDGE      1U     /* Set ISF to rising edge with DMA request */
+#define ISF_OFF            0U
+#define MUX_GPIO_ENABLE    1U
+#define MUX_FTM0_CH1       3U     /* PTA4 ALT3 */
+#define CNT_SETTLE_US      100U   /* Pull-up rise time after FTM0 lets go */
+#define PIN_4              4U
+#define CNT_MS_PER_SEC     1000U
+#define CNT_US_PER_SEC     1000000U
+
+#define CNT_DMA_CH         1U     /* Channel 0 belongs to IntScan */
+#define CNT_DMA_SLOT       49U    /* DMAMUX source for PORTA */
+#define CNT_DMA_LOOPS      0x7FFFU /* Edges one holdoff can count */
+#define CNT_DMA_WORD       2U     /* ATTR size code for 32 bits */
+#define CNT_MOD_MAX_SHIFT  3U
+#define SW2_SHIFT          4U
+#define CNT_BENCH_RUNS     32U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static volatile INT32U Sw_Cnt_Globe;    /* Hardware counter, updated by ISR */
+static volatile INT32U cntIsrCnt;       /* ISR entries */
+static volatile INT8U cntIsfLatch;      /* Software copy of ISF for combination */
+static INT32U cntSwCnt;                 /* Software polling counter */
+static INT32U cntCombCnt;               /* Combination counter */
+static INT32U cntLastSw;                /* Last sampled SW2 level */
+static INT32U cntDebLvl;                /* Debounced SW2 level */
+static INT32U cntDebTs;                 /* Last time the raw level equalled cntDebLvl */
+static INT32U cntPressCnt;              /* Debounced presses */
+static INT32U cntDownTs;                /* Time stamp of the last debounced press */
+static INT32U cntUpTs;                  /* and release */
+static INT8U cntPinOpts = PIN_OPT_NONE; /* SW2 filter options */
+static INT32U cntModUs;                 /* Holdoff, 0 for no moderation */
+static INT8U cntModShift;               /* Doublings of the next holdoff */
+static volatile INT32U cntRecovered;    /* Edges counted by DMA */
+static INT32U cntDmaSink;               /* DMA source and destination */
+static volatile INT32U cntOtherCnt;     /* Edges on other PORTA pins */
+static volatile INT32U cntStampIdx;     /* Edges time stamped */
+static volatile INT32U cntStamps[CNT_STAMPS]; /* Time stamp ring */
+static INT8U cntIsrSel = CNT_ISR_FULL;
+
+/* Everything the FTM0 pulses can move, put back by CntSelfDrive(FALSE) */
+typedef struct{
+    INT32U hw;
+    INT32U sw;
+    INT32U comb;
+    INT32U isr;
+    INT32U presses;
+    INT32U down;
+    INT32U up;
+    INT32U recovered;
+    INT32U other;
+    INT32U stamp_idx;
+}CNT_SAVED;
+static CNT_SAVED cntDriveSave;
+
+void PORTA_IRQHandler(void);
+void PIT0_IRQHandler(void);
+static inline void cntCountBody(void) __attribute__ ((always_inline));
+static inline void cntStampBody(void) __attribute__ ((always_inline));
+static inline void cntMultiBody(void) __attribute__ ((always_inline));
+static void cntIsrCount(void) RAMFUNC_ALWAYS;
+static void cntIsrStamp(void) RAMFUNC_ALWAYS;
+static void cntIsrMulti(void) RAMFUNC_ALWAYS;
+static void cntIsrCountFlash(void);
+static void cntIsrStampFlash(void);
+static void cntIsrMultiFlash(void);
+
+/* Handlers by CNT_ISR_xxx, RAM and flash copies */
+static const VEC_HANDLER cntIsrRam[CNT_NUM_ISR] = {
+    PORTA_IRQHandler, cntIsrCount, cntIsrStamp, cntIsrMulti};
+static const VEC_HANDLER cntIsrFlash[CNT_NUM_ISR] = {
+    PORTA_IRQHandler, cntIsrCountFlash, cntIsrStampFlash, cntIsrMultiFlash};
+
+/****************************************************************************************
+* CntInit() - Configures SW2 (PTA4) for rising edge interrupts and starts all
+*             counting strategies from zero.
+****************************************************************************************/
+void CntInit(void){
+    Sw_Cnt_Globe = 0;
+    cntIsrCnt = 0;
+    cntIsfLatch = FALSE;
+    cntSwCnt = 0;
+    cntCombCnt = 0;
+    cntLastSw = SW2_BIT;        /*Preset to 1 b/c GPIOA_PDIR is active low */
+    cntDebLvl = SW2_BIT;
+    cntDebTs = TS_GET();
+    cntPressCnt = 0;
+    cntRecovered = 0;
+    cntModShift = 0;
+    cntOtherCnt = 0;
+    cntStampIdx = 0;
+
+    /* SW2 is active low thus detect rising edge
+     *  for when user stops pressing SW2 */
+    PinConfig(PIN_PORTA, PIN_4, MUX_GPIO_ENABLE, ISF_INT_REDGE, cntPinOpts);
+    SW2_CLR_ISF();
+    NVIC_ClearPendingIRQ(PORTA_IRQn);
+    NVIC_EnableIRQ(PORTA_IRQn);
+}
+
+/****************************************************************************************
+* CntTask() - Services the polled strategies (software and combination).
+*             Never blocks. Call once per main loop pass.
+****************************************************************************************/
+RAMFUNC void CntTask(void){
+    INT32U currsw;
+
+    /* Software counter - SW2 is active low thus detect rising edge
+     *  for when user stops pressing SW2 */
+    currsw = SW2_INPUT;
+    if ((currsw == SW2_BIT) && (cntLastSw == 0x00)) {
+        cntSwCnt++;
+    } else {}
+    cntLastSw = currsw;
+
+    /* Debounced reference - count a release once it has been stable */
+    if (currsw == cntDebLvl){
+        cntDebTs = TS_GET();
+    } else if ((TS_GET() - cntDebTs) >= (SystemCoreClock / CNT_MS_PER_SEC) * CNT_DEB_MS){
+        /* The edge was just after the last sample at the old level */
+        cntDebLvl = currsw;
+        if (currsw == SW2_BIT){
+            cntUpTs = cntDebTs;
+            cntPressCnt++;
+        } else {
+            cntDownTs = cntDebTs;
+        }
+    } else {}
+
+    /* Combination counter - when the latched flag is set, clear it, & count */
+    if (cntIsfLatch != FALSE){
+        cntIsfLatch = FALSE;
+        cntCombCnt++;
+    } else {}
+}
+
+/****************************************************************************************
+* CntGet() - Returns the accumulated count of a strategy.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: count since CntInit() on top of any CntRestore(), 0 for an
+*            unknown strategy
+****************************************************************************************/
+INT32U CntGet(INT8U strat){
+    INT32U cnt;
+    switch(strat){
+    case(CNT_SOFTWARE):
+        cnt = cntSwCnt;
+        break;
+    case(CNT_HARDWARE):
+        cnt = Sw_Cnt_Globe;
+        break;
+    case(CNT_COMBINATION):
+        cnt = cntCombCnt;
+        break;
+    default:
+        cnt = 0;
+        break;
+    }
+    return cnt;
+}
+
+/****************************************************************************************
+* CntRestore() - Continues the strategy counts from saved values. The polled
+*                strategies and the ISR go on counting from there.
+*    Parameters: cnt holds a count per strategy, indexed by CNT_xxx
+****************************************************************************************/
+void CntRestore(const INT32U *cnt){
+    __disable_irq();
+    cntSwCnt = cnt[CNT_SOFTWARE];
+    Sw_Cnt_Globe = cnt[CNT_HARDWARE];
+    cntCombCnt = cnt[CNT_COMBINATION];
+    __enable_irq();
+}
+
+/****************************************************************************************
+* CntFilter() - Selects the SW2 input filter.
+*    Parameters: filt is CNT_FILT_xxx
+*                width is the digital filter width in filter clocks, 1-31
+****************************************************************************************/
+void CntFilter(INT8U filt, INT8U width){
+    switch(filt){
+    case(CNT_FILT_PASSIVE):
+        cntPinOpts = PIN_OPT_PASSIVE;
+        break;
+    case(CNT_FILT_BUS):
+        PinFilterClock(PIN_PORTA, PIN_FILT_BUS, width);
+        cntPinOpts = PIN_OPT_DIGITAL;
+        break;
+    case(CNT_FILT_LPO):
+        PinFilterClock(PIN_PORTA, PIN_FILT_LPO, width);
+        cntPinOpts = PIN_OPT_DIGITAL;
+        break;
+    default:
+        cntPinOpts = PIN_OPT_NONE;
+        break;
+    }
+    PinConfig(PIN_PORTA, PIN_4, MUX_GPIO_ENABLE, ISF_INT_REDGE, cntPinOpts);
+}
+
+/****************************************************************************************
+* CntIsrEntries() - Number of PORTA_IRQHandler() entries since CntInit().
+****************************************************************************************/
+INT32U CntIsrEntries(void){
+    return cntIsrCnt;
+}
+
+/****************************************************************************************
+* CntPresses() - Number of SW2 presses since CntInit() seen by a software
+*                debouncer that needs the level stable for CNT_DEB_MS. This is
+*                the reference the filters are judged against.
+****************************************************************************************/
+INT32U CntPresses(void){
+    return cntPressCnt;
+}
+
+/****************************************************************************************
+* CntLastPress() - Time stamps of the debounced press and release edges of the
+*                  last press counted by CntPresses().
+****************************************************************************************/
+void CntLastPress(INT32U *down, INT32U *up){
+    *down = cntDownTs;
+    *up = cntUpTs;
+}
+
+/****************************************************************************************
+* CntModerate() - Sets the interrupt moderation holdoff.
+*    Parameters: us is the holdoff after an SW2 interrupt, in microseconds.
+*                0 turns moderation off.
+****************************************************************************************/
+void CntModerate(INT32U us){
+    if((us != 0) && (cntModUs == 0)){
+        SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK | SIM_SCGC6_PIT_MASK;
+        SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+        PIT->MCR = 0;
+        PIT->CHANNEL[0].TCTRL = 0;
+        PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF_MASK;
+
+        /* Each request moves one word onto itself, only CITER matters */
+        DMAMUX->CHCFG[CNT_DMA_CH] = 0;
+        DMA0->TCD[CNT_DMA_CH].SADDR = (INT32U)&cntDmaSink;
+        DMA0->TCD[CNT_DMA_CH].SOFF = 0;
+        DMA0->TCD[CNT_DMA_CH].ATTR = DMA_ATTR_SSIZE(CNT_DMA_WORD) | DMA_ATTR_DSIZE(CNT_DMA_WORD);
+        DMA0->TCD[CNT_DMA_CH].NBYTES_MLNO = 4U;
+        DMA0->TCD[CNT_DMA_CH].SLAST = 0;
+        DMA0->TCD[CNT_DMA_CH].DADDR = (INT32U)&cntDmaSink;
+        DMA0->TCD[CNT_DMA_CH].DOFF = 0;
+        DMA0->TCD[CNT_DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(CNT_DMA_LOOPS);
+        DMA0->TCD[CNT_DMA_CH].DLAST_SGA = 0;
+        DMA0->TCD[CNT_DMA_CH].CSR = 0;
+        DMA0->TCD[CNT_DMA_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(CNT_DMA_LOOPS);
+        DMAMUX->CHCFG[CNT_DMA_CH] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(CNT_DMA_SLOT);
+        DMA0->SERQ = CNT_DMA_CH;
+
+        NVIC_ClearPendingIRQ(PIT0_IRQn);
+        NVIC_EnableIRQ(PIT0_IRQn);
+    }else{
+    }
+    cntModShift = 0;
+    cntModUs = us;
+}
+
+/****************************************************************************************
+* CntRecovered() - Number of SW2 edges counted by DMA during holdoffs. They are
+*                  included in the hardware count but never entered the ISR.
+****************************************************************************************/
+INT32U CntRecovered(void){
+    return cntRecovered;
+}
+
+/****************************************************************************************
+* CntSelfDrive() - Hands PTA4 to FTM0 channel 1 or back to GPIO.
+*    Parameters: on is TRUE to drive SW2 from FTM0. The port interrupt and
+*                PDIR still see the pin, so every counter counts the FTM0
+*                output. When FALSE the pin goes back to GPIO and the rising
+*                edge it makes as the pull-up takes over is not counted.
+*                Every count, press, ISR entry and time stamp is put back to
+*                what it was at CntSelfDrive(TRUE), so the driven pulses never
+*                reach the history, rate, stats or counter log.
+****************************************************************************************/
+void CntSelfDrive(INT8U on){
+    INT32U start;
+    if(on != FALSE){
+        __disable_irq();
+        cntDriveSave.hw = Sw_Cnt_Globe;
+        cntDriveSave.sw = cntSwCnt;
+        cntDriveSave.comb = cntCombCnt;
+        cntDriveSave.isr = cntIsrCnt;
+        cntDriveSave.presses = cntPressCnt;
+        cntDriveSave.down = cntDownTs;
+        cntDriveSave.up = cntUpTs;
+        cntDriveSave.recovered = cntRecovered;
+        cntDriveSave.other = cntOtherCnt;
+        cntDriveSave.stamp_idx = cntStampIdx;
+        __enable_irq();
+        PinConfig(PIN_PORTA, PIN_4, MUX_FTM0_CH1, ISF_INT_REDGE, cntPinOpts);
+    }else{
+        PinConfig(PIN_PORTA, PIN_4, MUX_GPIO_ENABLE, ISF_OFF, cntPinOpts);
+        start = TS_GET();
+        while((TS_GET() - start) < ((SystemCoreClock / CNT_US_PER_SEC) * CNT_SETTLE_US)){
+        }
+        SW2_CLR_ISF();
+        cntLastSw = SW2_INPUT;
+        cntDebLvl = cntLastSw;
+        cntDebTs = TS_GET();
+
+        /* Take the driven edges back out, the main loop never sees them */
+        __disable_irq();
+        Sw_Cnt_Globe = cntDriveSave.hw;
+        cntSwCnt = cntDriveSave.sw;
+        cntCombCnt = cntDriveSave.comb;
+        cntIsrCnt = cntDriveSave.isr;
+        cntPressCnt = cntDriveSave.presses;
+        cntDownTs = cntDriveSave.down;
+        cntUpTs = cntDriveSave.up;
+        cntRecovered = cntDriveSave.recovered;
+        cntOtherCnt = cntDriveSave.other;
+        cntStampIdx = cntDriveSave.stamp_idx;
+        cntIsfLatch = FALSE;
+        __enable_irq();
+        PinIrqSet(PIN_PORTA, PIN_4, ISF_INT_REDGE);
+    }
+}
+
+/****************************************************************************************
+* CntIsrMode() - Installs the PORTA handler for a mode. Needs VecInit().
+*    Parameters: mode is CNT_ISR_xxx
+****************************************************************************************/
+void CntIsrMode(INT8U mode){
+    if(mode < CNT_NUM_ISR){
+        cntIsrSel = mode;
+        (void)VecSet(PORTA_IRQn, cntIsrRam[mode]);
+    }else{
+    }
+}
+
+/****************************************************************************************
+* CntIsrBench() - Times pended PORTA interrupts, from setting the pending bit to
+*                 the return from the handler, with the handler of a mode taken
+*                 from RAM or flash. The active mode is restored afterwards and
+*                 the bench entries are taken back out of CntIsrEntries().
+*    Parameters: mode is CNT_ISR_COUNT, CNT_ISR_STAMP or CNT_ISR_MULTI
+*                ram is TRUE for the RAM handler, FALSE for its flash twin
+*                *worst is set to the slowest run
+*    return: fastest run in core cycles, 0 for CNT_ISR_FULL, which counts
+*            every entry
+****************************************************************************************/
+INT32U CntIsrBench(INT8U mode, INT8U ram, INT32U *worst){
+    INT32U best = 0;
+    INT32U start;
+    INT32U cycles;
+    INT32U i;
+    *worst = 0;
+    if((mode != CNT_ISR_FULL) && (mode < CNT_NUM_ISR)){
+        if(ram != FALSE){
+            (void)VecSet(PORTA_IRQn, cntIsrRam[mode]);
+        }else{
+            (void)VecSet(PORTA_IRQn, cntIsrFlash[mode]);
+        }
+        best = 0xFFFFFFFFU;
+        for(i = 0; i < CNT_BENCH_RUNS; i++){
+            start = TS_GET();
+            NVIC_SetPendingIRQ(PORTA_IRQn);
+            __DSB();
+            __ISB();
+            cycles = TS_GET() - start;
+            if(cycles < best){
+                best = cycles;
+            }else{
+            }
+            if(cycles > *worst){
+                *worst = cycles;
+            }else{
+            }
+        }
+        (void)VecSet(PORTA_IRQn, cntIsrRam[cntIsrSel]);
+        __disable_irq();
+        cntIsrCnt -= CNT_BENCH_RUNS;
+        __enable_irq();
+    }else{
+    }
+    return best;
+}
+
+/****************************************************************************************
+* CntStamps() - Copies the time stamps of the last SW2 edges counted in
+*               CNT_ISR_STAMP mode, oldest first.
+*    Parameters: stamps has room for CNT_STAMPS time stamps
+*    return: number of time stamps copied
+****************************************************************************************/
+INT8U CntStamps(INT32U *stamps){
+    INT32U last;
+    INT32U n;
+    INT32U i;
+    /* A full ring's oldest slot is the one the next edge writes */
+    __disable_irq();
+    last = cntStampIdx;
+    n = (last < CNT_STAMPS) ? last : CNT_STAMPS;
+    for(i = 0; i < n; i++){
+        stamps[i] = cntStamps[(last - n + i) & (CNT_STAMPS - 1U)];
+    }
+    __enable_irq();
+    return (INT8U)n;
+}
+
+/****************************************************************************************
+* CntStampsNew() - Copies the time stamps taken since *next, oldest first, and
+*                  moves *next past them. If more than CNT_STAMPS were taken
+*                  only the newest CNT_STAMPS are left, so *next moves by more
+*                  than the number copied.
+*    Parameters: *next is the number of the first stamp wanted, start at 0
+*                stamps has room for CNT_STAMPS time stamps
+*    return: number of time stamps copied
+****************************************************************************************/
+INT8U CntStampsNew(INT32U *next, INT32U *stamps){
+    INT32U last;
+    INT32U n;
+    INT32U i;
+    /* A full ring's oldest slot is the one the next edge writes */
+    __disable_irq();
+    last = cntStampIdx;
+    n = last - *next;
+    if(n > CNT_STAMPS){
+        n = CNT_STAMPS;
+    }else{
+    }
+    for(i = 0; i < n; i++){
+        stamps[i] = cntStamps[(last - n + i) & (CNT_STAMPS - 1U)];
+    }
+    __enable_irq();
+    *next = last;
+    return (INT8U)n;
+}
+
+/****************************************************************************************
+* CntEdgeLatency() - Drives one rising edge onto SW2 from GPIOA and times it to
+*                    the CNT_ISR_STAMP handler's time stamp. The active handler
+*                    is put back and the edge is taken back out of every count.
+*                    SW2 must not be pressed.
+*    return: core cycles from the pin write to the time stamp, 0 if no
+*            interrupt came within CNT_LAT_TIMEOUT_US, which a wide filter
+*            can cause
+****************************************************************************************/
+INT32U CntEdgeLatency(void){
+    INT32U idx = cntStampIdx;
+    INT32U entries = cntIsrCnt;
+    INT8U latch = cntIsfLatch;
+    INT32U timeout = (SystemCoreClock / CNT_US_PER_SEC) * CNT_LAT_TIMEOUT_US;
+    INT32U start;
+    INT32U lat = 0;
+    INT32U edges;
+
+    (void)VecSet(PORTA_IRQn, cntIsrRam[CNT_ISR_STAMP]);
+    /* Low for a while first, the pin may still be rising from the last edge */
+    GPIOA->PCOR = SW2_BIT;
+    GPIOA->PDDR |= SW2_BIT;
+    start = TS_GET();
+    while((TS_GET() - start) < timeout){
+    }
+    start = TS_GET();
+    GPIOA->PSOR = SW2_BIT;
+    while((cntStampIdx == idx) && ((TS_GET() - start) < timeout)){
+    }
+    GPIOA->PDDR &= ~SW2_BIT;
+    if(cntStampIdx != idx){
+        lat = cntStamps[idx & (CNT_STAMPS - 1U)] - start;
+    }else{
+    }
+
+    __disable_irq();
+    edges = cntStampIdx - idx;
+    Sw_Cnt_Globe -= edges;
+    cntIsrCnt = entries;
+    cntStampIdx = idx;
+    cntIsfLatch = latch;
+    __enable_irq();
+    (void)VecSet(PORTA_IRQn, cntIsrRam[cntIsrSel]);
+    return lat;
+}
+
+/****************************************************************************************
+* CntOtherEdges() - Edges on PORTA pins other than SW2, counted in
+*                   CNT_ISR_MULTI mode.
+****************************************************************************************/
+INT32U CntOtherEdges(void){
+    return cntOtherCnt;
+}
+
+/****************************************************************************************
+* cntCountBody() - Counts the SW2 flag. Private.
+****************************************************************************************/
+static inline void cntCountBody(void){
+    INT32U edge;
+    edge = PORTA->ISFR & SW2_BIT;
+    PORTA->ISFR = edge;
+    edge >>= SW2_SHIFT;
+    Sw_Cnt_Globe += edge;
+    cntIsfLatch |= (INT8U)edge;
+    cntIsrCnt++;
+}
+
+/****************************************************************************************
+* cntStampBody() - Counts the SW2 flag and time stamps it. The ring slot is
+*                  always written but only kept when there was an edge. Private.
+****************************************************************************************/
+static inline void cntStampBody(void){
+    INT32U now = TS_GET();
+    INT32U edge;
+    INT32U idx = cntStampIdx;
+    edge = PORTA->ISFR & SW2_BIT;
+    PORTA->ISFR = edge;
+    edge >>= SW2_SHIFT;
+    cntStamps[idx & (CNT_STAMPS - 1U)] = now;
+    cntStampIdx = idx + edge;
+    Sw_Cnt_Globe += edge;
+    cntIsfLatch |= (INT8U)edge;
+    cntIsrCnt++;
+}
+
+/****************************************************************************************
+* cntMultiBody() - Clears every PORTA flag in one pass. SW2 goes to the hardware
+*                  counter, the rest are added up with a bit count. Private.
+****************************************************************************************/
+static inline void cntMultiBody(void){
+    INT32U flags;
+    INT32U edge;
+    INT32U other;
+    flags = PORTA->ISFR;
+    PORTA->ISFR = flags;
+    edge = (flags & SW2_BIT) >> SW2_SHIFT;
+    other = flags & ~SW2_BIT;
+    other = other - ((other >> 1) & 0x55555555U);
+    other = (other & 0x33333333U) + ((other >> 2) & 0x33333333U);
+    other = (((other + (other >> 4)) & 0x0F0F0F0FU) * 0x01010101U) >> 24;
+    cntOtherCnt += other;
+    Sw_Cnt_Globe += edge;
+    cntIsfLatch |= (INT8U)edge;
+    cntIsrCnt++;
+}
+
+static void cntIsrCount(void){
+    LOAD_ISR_ENTRY();
+    cntCountBody();
+    LOAD_ISR_EXIT();
+}
+
+static void cntIsrStamp(void){
+    LOAD_ISR_ENTRY();
+    cntStampBody();
+    LOAD_ISR_EXIT();
+}
+
+static void cntIsrMulti(void){
+    LOAD_ISR_ENTRY();
+    cntMultiBody();
+    LOAD_ISR_EXIT();
+}
+
+static void cntIsrCountFlash(void){
+    LOAD_ISR_ENTRY();
+    cntCountBody();
+    LOAD_ISR_EXIT();
+}
+
+static void cntIsrStampFlash(void){
+    LOAD_ISR_ENTRY();
+    cntStampBody();
+    LOAD_ISR_EXIT();
+}
+
+static void cntIsrMultiFlash(void){
+    LOAD_ISR_ENTRY();
+    cntMultiBody();
+    LOAD_ISR_EXIT();
+}
+
+/**********************************************************************************
+* PORTA-IRQHandler()
+*
+* Description:  clears ISF for SW2 immediately then updates
+*               global variable Sw_Cnt_Globe for the hardware counter and
+*               latches the flag for the combination counter
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+RAMFUNC void PORTA_IRQHandler(void){
+    LOAD_ISR_ENTRY();
+    SW2_CLR_ISF();
+    cntIsrCnt++;
+    Sw_Cnt_Globe++;
+    cntIsfLatch = TRUE;
+    if(cntModUs != 0){
+        /* Hand the following edges to DMA until PIT0 re-arms the interrupt */
+        PinIrqSet(PIN_PORTA, PIN_4, ISF_DMA_REDGE);
+        PIT->CHANNEL[0].TCTRL = 0;
+        PIT->CHANNEL[0].LDVAL = ((K65TWR_BusClock() / CNT_US_PER_SEC) * (cntModUs << cntModShift)) - 1U;
+        PIT->CHANNEL[0].TCTRL = PIT_TCTRL_TIE_MASK | PIT_TCTRL_TEN_MASK;
+    } else {}
+    LOAD_ISR_EXIT();
+}
+
+/**********************************************************************************
+* PIT0_IRQHandler()
+*
+* Description:  ends an SW2 holdoff. Puts SW2 back in interrupt mode, adds the
+*               edges DMA counted during the holdoff to the hardware counter
+*               and sets the length of the next holdoff.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+RAMFUNC void PIT0_IRQHandler(void){
+    LOAD_ISR_ENTRY();
+    INT32U edges;
+
+    PIT->CHANNEL[0].TCTRL = 0;
+    PIT->CHANNEL[0].TFLG = PIT_TFLG_TIF_MASK;
+    PinIrqSet(PIN_PORTA, PIN_4, ISF_INT_REDGE);
+
+    /* An edge just before the switch may still be in service */
+    while((DMA0->TCD[CNT_DMA_CH].CSR & DMA_CSR_ACTIVE_MASK) != 0){
+    }
+    edges = CNT_DMA_LOOPS - (DMA0->TCD[CNT_DMA_CH].CITER_ELINKNO & DMA_CITER_ELINKNO_CITER_MASK);
+    DMA0->TCD[CNT_DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(CNT_DMA_LOOPS);
+
+    if(edges != 0){
+        Sw_Cnt_Globe += edges;
+        cntRecovered += edges;
+        cntIsfLatch = TRUE;
+        if(cntModShift < CNT_MOD_MAX_SHIFT){
+            cntModShift++;
+        } else {}
+    } else {
+        cntModShift = 0;
+    }
+    LOAD_ISR_EXIT();
+}
@@ -0,0 +1,190 @@
+/****************************************************************************************
+* Counter.h - Background SW2 counting for rsLab3Project.
+*
+*   All three counting strategies (software polling, hardware interrupt, and the
+*   hardware flag/software poll combination) run continuously, independent of
+*   which one is being displayed. CntTask() must be called from every pass of the
+*   main loop so the polled strategies keep up with SW2.
+*
+*   SW2 bounces, so every strategy can count more than one edge per press.
+*   CntFilter() selects the pin's passive or digital filter to suppress that.
+*
+*   CntModerate() caps the interrupt rate of a noisy SW2: after each interrupt
+*   the following edges are counted by DMA for a holdoff time, so the hardware
+*   count stays exact with at most one ISR entry per holdoff.
+*
+*   CntIsrMode() replaces the PORTA handler with a smaller one that runs from
+*   SRAM_L: plain counting, counting with a time stamp per edge, or counting the
+*   edges of every PORTA pin. VecInit() must be called first.
+*
+****************************************************************************************/
+#ifndef CNT_INCL
+#define CNT_INCL
+
+/****************************************************************************************
+* Counting strategies - used as an index for CntGet()
+****************************************************************************************/
+#define CNT_SOFTWARE        0U
+#define CNT_HARDWARE        1U
+#define CNT_COMBINATION     2U
+#define CNT_NUM_STRAT       3U
+
+/****************************************************************************************
+* SW2 input filters - used with CntFilter()
+****************************************************************************************/
+#define CNT_FILT_OFF        0U
+#define CNT_FILT_PASSIVE    1U      /* Passive pin filter */
+#define CNT_FILT_BUS        2U      /* Digital filter on the bus clock */
+#define CNT_FILT_LPO        3U      /* Digital filter on the 1kHz LPO */
+#define CNT_NUM_FILT        4U
+
+#define CNT_DEB_MS          10U     /* Software debouncer stable time */
+
+/****************************************************************************************
+* PORTA handler modes - used with CntIsrMode()
+****************************************************************************************/
+#define CNT_ISR_FULL        0U      /* Default handler with moderation, SRAM_L if RAMFUNC_EN */
+#define CNT_ISR_COUNT       1U      /* Count SW2 */
+#define CNT_ISR_STAMP       2U      /* Count and time stamp SW2 */
+#define CNT_ISR_MULTI       3U      /* Count SW2 and the other PORTA pins */
+#define CNT_NUM_ISR         4U
+
+#define CNT_STAMPS          16U     /* Time stamps kept, power of 2 */
+#define CNT_LAT_TIMEOUT_US  100U    /* Wait for the CntEdgeLatency() interrupt */
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* CntInit() - Configures SW2 (PTA4) for rising edge interrupts and starts all
+*             counting strategies from zero.
+****************************************************************************************/
+void CntInit(void);
+
+/****************************************************************************************
+* CntTask() - Services the polled strategies (software and combination).
+*             Never blocks. Call once per main loop pass.
+****************************************************************************************/
+void CntTask(void);
+
+/****************************************************************************************
+* CntGet() - Returns the accumulated count of a strategy.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: count since CntInit() on top of any CntRestore(), 0 for an
+*            unknown strategy
+****************************************************************************************/
+INT32U CntGet(INT8U strat);
+
+/****************************************************************************************
+* CntRestore() - Continues the strategy counts from saved values. The polled
+*                strategies and the ISR go on counting from there.
+*    Parameters: cnt holds a count per strategy, indexed by CNT_xxx
+****************************************************************************************/
+void CntRestore(const INT32U *cnt);
+
+/****************************************************************************************
+* CntFilter() - Selects the SW2 input filter.
+*    Parameters: filt is CNT_FILT_xxx
+*                width is the digital filter width in filter clocks, 1-31
+****************************************************************************************/
+void CntFilter(INT8U filt, INT8U width);
+
+/****************************************************************************************
+* CntIsrEntries() - Number of PORTA_IRQHandler() entries since CntInit().
+****************************************************************************************/
+INT32U CntIsrEntries(void);
+
+/****************************************************************************************
+* CntPresses() - Number of SW2 presses since CntInit() seen by a software
+*                debouncer that needs the level stable for CNT_DEB_MS. This is
+*                the reference the filters are judged against.
+****************************************************************************************/
+INT32U CntPresses(void);
+
+/****************************************************************************************
+* CntLastPress() - Time stamps of the debounced press and release edges of the
+*                  last press counted by CntPresses().
+****************************************************************************************/
+void CntLastPress(INT32U *down, INT32U *up);
+
+/****************************************************************************************
+* CntModerate() - Sets the interrupt moderation holdoff.
+*    Parameters: us is the holdoff after an SW2 interrupt, in microseconds.
+*                0 turns moderation off.
+****************************************************************************************/
+void CntModerate(INT32U us);
+
+/****************************************************************************************
+* CntRecovered() - Number of SW2 edges counted by DMA during holdoffs. They are
+*                  included in the hardware count but never entered the ISR.
+****************************************************************************************/
+INT32U CntRecovered(void);
+
+/****************************************************************************************
+* CntSelfDrive() - Hands PTA4 to FTM0 channel 1 or back to GPIO.
+*    Parameters: on is TRUE to drive SW2 from FTM0. The port interrupt and
+*                PDIR still see the pin, so every counter counts the FTM0
+*                output. When FALSE the pin goes back to GPIO and the rising
+*                edge it makes as the pull-up takes over is not counted.
+*                Every count, press, ISR entry and time stamp is put back to
+*                what it was at CntSelfDrive(TRUE), so the driven pulses never
+*                reach the history, rate, stats or counter log.
+****************************************************************************************/
+void CntSelfDrive(INT8U on);
+
+/****************************************************************************************
+* CntIsrMode() - Installs the PORTA handler for a mode. Needs VecInit().
+*    Parameters: mode is CNT_ISR_xxx
+****************************************************************************************/
+void CntIsrMode(INT8U mode);
+
+/****************************************************************************************
+* CntIsrBench() - Times pended PORTA interrupts, from setting the pending bit to
+*                 the return from the handler, with the handler of a mode taken
+*                 from RAM or flash. The active mode is restored afterwards and
+*                 the bench entries are taken back out of CntIsrEntries().
+*    Parameters: mode is CNT_ISR_COUNT, CNT_ISR_STAMP or CNT_ISR_MULTI
+*                ram is TRUE for the RAM handler, FALSE for its flash twin
+*                *worst is set to the slowest run
+*    return: fastest run in core cycles, 0 for CNT_ISR_FULL, which counts
+*            every entry
+****************************************************************************************/
+INT32U CntIsrBench(INT8U mode, INT8U ram, INT32U *worst);
+
+/****************************************************************************************
+* CntStamps() - Copies the time stamps of the last SW2 edges counted in
+*               CNT_ISR_STAMP mode, oldest first.
+*    Parameters: stamps has room for CNT_STAMPS time stamps
+*    return: number of time stamps copied
+****************************************************************************************/
+INT8U CntStamps(INT32U *stamps);
+
+/****************************************************************************************
+* CntStampsNew() - Copies the time stamps taken since *next, oldest first, and
+*                  moves *next past them. If more than CNT_STAMPS were taken
+*                  only the newest CNT_STAMPS are left, so *next moves by more
+*                  than the number copied.
+*    Parameters: *next is the number of the first stamp wanted, start at 0
+*                stamps has room for CNT_STAMPS time stamps
+*    return: number of time stamps copied
+****************************************************************************************/
+INT8U CntStampsNew(INT32U *next, INT32U *stamps);
+
+/****************************************************************************************
+* CntEdgeLatency() - Drives one rising edge onto SW2 from GPIOA and times it to
+*                    the CNT_ISR_STAMP handler's time stamp. The active handler
+*                    is put back and the edge is taken back out of every count.
+*                    SW2 must not be pressed.
+*    return: core cycles from the pin write to the time stamp, 0 if no
+*            interrupt came within CNT_LAT_TIMEOUT_US, which a wide filter
+*            can cause
+****************************************************************************************/
+INT32U CntEdgeLatency(void);
+
+/****************************************************************************************
+* CntOtherEdges() - Edges on PORTA pins other than SW2, counted in
+*                   CNT_ISR_MULTI mode.
+****************************************************************************************/
+INT32U CntOtherEdges(void);
+
+#endif
@@ -0,0 +1,101 @@
+/****************************************************************************************
+* CpuLoad.c - CPU load monitor.
+*
+*   A pass's cycles go to LOAD_IDLE or LOAD_POLL after the ISR and UART cycles
+*   that happened during it are taken out. The window closes on the first pass
+*   that ends after a second has gone by, so it is a little longer than
+*   SystemCoreClock cycles and the shares are taken from its real length.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "TimeStamp.h"
+#include "CpuLoad.h"
+
+#define LOAD_PERMILLE       1000U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+volatile INT32U LoadIsrCycles;
+
+static INT32U loadAcc[LOAD_NUM_CAT];    /* Cycles in the open window */
+static INT16U loadLast[LOAD_NUM_CAT];   /* Shares of the last window */
+static INT32U loadWinStart;             /* Time stamp the window opened */
+static INT32U loadPassStart;            /* Time stamp the pass started */
+static INT32U loadIsrPrev;              /* LoadIsrCycles at the last pass */
+static INT32U loadUartPrev;             /* BIOTxCycles() at the last pass */
+
+/****************************************************************************************
+* LoadInit() - Starts the first window. Needs TSInit().
+****************************************************************************************/
+void LoadInit(void){
+    INT8U cat;
+    for(cat = 0; cat < LOAD_NUM_CAT; cat++){
+        loadAcc[cat] = 0;
+        loadLast[cat] = 0;
+    }
+    loadIsrPrev = LoadIsrCycles;
+    loadUartPrev = BIOTxCycles();
+    loadWinStart = TS_GET();
+    loadPassStart = loadWinStart;
+}
+
+/****************************************************************************************
+* LoadPass() - Accounts the main loop pass that just ended.
+*    Parameters: idle is TRUE if the pass only looked for input. A pass that
+*                wrote to the UART is never idle.
+*    return: TRUE when a new one second window has completed
+****************************************************************************************/
+INT8U LoadPass(INT8U idle){
+    INT32U now = TS_GET();
+    INT32U isr = LoadIsrCycles;
+    INT32U uart = BIOTxCycles();
+    INT32U pass;
+    INT32U win;
+    INT8U cat;
+    INT8U done = FALSE;
+
+    pass = now - loadPassStart;
+    isr -= loadIsrPrev;
+    uart -= loadUartPrev;
+    loadIsrPrev += isr;
+    loadUartPrev += uart;
+    loadPassStart = now;
+
+    /* Rest of the pass after the ISR and UART cycles, never below zero */
+    pass = (pass > (isr + uart)) ? (pass - isr - uart) : 0U;
+    loadAcc[LOAD_ISR] += isr;
+    loadAcc[LOAD_UART] += uart;
+    if((idle != FALSE) && (uart == 0)){
+        loadAcc[LOAD_IDLE] += pass;
+    }else{
+        loadAcc[LOAD_POLL] += pass;
+    }
+
+    win = now - loadWinStart;
+    if(win >= SystemCoreClock){
+        for(cat = 0; cat < LOAD_NUM_CAT; cat++){
+            loadLast[cat] = (INT16U)(((INT64U)loadAcc[cat] * LOAD_PERMILLE) / win);
+            loadAcc[cat] = 0;
+        }
+        loadWinStart = now;
+        done = TRUE;
+    }else{
+    }
+    return done;
+}
+
+/****************************************************************************************
+* LoadGet() - Share of a category in the last complete window.
+*    Parameters: cat is LOAD_xxx
+*    return: tenths of a percent, 0-1000
+****************************************************************************************/
+INT16U LoadGet(INT8U cat){
+    INT16U share = 0;
+    if(cat < LOAD_NUM_CAT){
+        share = loadLast[cat];
+    }else{
+    }
+    return share;
+}
@@ -0,0 +1,58 @@
+/****************************************************************************************
+* CpuLoad.h - CPU load monitor.
+*
+*   Every core cycle of a one second window is put in one category:
+*   LOAD_ISR    interrupt handler bodies, bracketed with LOAD_ISR_ENTRY() and
+*               LOAD_ISR_EXIT()
+*   LOAD_UART   BIOWrite(), waiting for and loading the transmitter
+*   LOAD_POLL   main loop passes that did something besides looking for input:
+*               counting, parsing, checksum steps and output formatting
+*   LOAD_IDLE   main loop passes that found nothing to do
+*   The main loop calls LoadPass() once per pass. The categories are measured
+*   with the DWT cycle counter, so the exception entry and exit of roughly a
+*   dozen cycles per interrupt end up in the main loop categories.
+*
+****************************************************************************************/
+#ifndef LOAD_INCL
+#define LOAD_INCL
+
+#define LOAD_ISR            0U
+#define LOAD_UART           1U
+#define LOAD_POLL           2U
+#define LOAD_IDLE           3U
+#define LOAD_NUM_CAT        4U
+
+/* Handler cycles, only written through the macros below */
+extern volatile INT32U LoadIsrCycles;
+
+/****************************************************************************************
+* LOAD_ISR_ENTRY(), LOAD_ISR_EXIT() - First and last statement of a handler.
+*                                     No call, so they can be used in SRAM_L.
+****************************************************************************************/
+#define LOAD_ISR_ENTRY()    INT32U load_isr_start = TS_GET()
+#define LOAD_ISR_EXIT()     (LoadIsrCycles += TS_GET() - load_isr_start)
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* LoadInit() - Starts the first window. Needs TSInit().
+****************************************************************************************/
+void LoadInit(void);
+
+/****************************************************************************************
+* LoadPass() - Accounts the main loop pass that just ended.
+*    Parameters: idle is TRUE if the pass only looked for input. A pass that
+*                wrote to the UART is never idle.
+*    return: TRUE when a new one second window has completed
+****************************************************************************************/
+INT8U LoadPass(INT8U idle);
+
+/****************************************************************************************
+* LoadGet() - Share of a category in the last complete window.
+*    Parameters: cat is LOAD_xxx
+*    return: tenths of a percent, 0-1000
+****************************************************************************************/
+INT16U LoadGet(INT8U cat);
+
+#endif
@@ -0,0 +1,252 @@
+/****************************************************************************************
+* FreqMeter.c - Gated and reciprocal frequency meter on LPTMR0.
+*
+*   LPTMR0 runs in pulse counter mode with the prescaler and glitch filter
+*   bypassed. Its counter is 16 bits, so in gated mode the compare is set to
+*   the top and each compare interrupt adds 2^16 to freqEdges. In reciprocal
+*   mode the compare is N - 1 and each interrupt adds N and time stamps it.
+*   The compare can only be written with TCF set, so N changes in the LPTMR
+*   interrupt, and the mode switches restart the counter.
+*
+*   Gate lengths come from the DWT cycle counter at each interrupt rather
+*   than from the PIT load value, so they also hold the interrupt latency
+*   difference of the two ends, a few cycles. Reciprocal mode gives up and
+*   reports 0Hz when no interrupt came for FREQ_IDLE_MS, which keeps the
+*   time stamps well inside their 23.8s wrap.
+*
+*   Both interrupts are left at the same priority so neither preempts the
+*   other.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "K65TWR_ClkCfg.h"
+#include "PinCfg.h"
+#include "CpuLoad.h"
+#include "TimeStamp.h"
+#include "FreqMeter.h"
+
+#define FREQ_PIT_CH         1U      /* Channel 0 is the SW2 holdoff */
+#define FREQ_PIN            5U      /* PTC5 */
+#define FREQ_MUX_LPTMR      3U      /* PTC5 ALT3, LPTMR0_ALT2 */
+#define FREQ_TPS_ALT2       2U
+#define FREQ_PCS_LPO        1U
+#define FREQ_CMR_TOP        0xFFFFU
+#define FREQ_IDLE_MS        20000U
+#define FREQ_MS_PER_S       1000U
+#define FREQ_CSR            (LPTMR_CSR_TEN_MASK | LPTMR_CSR_TMS_MASK | LPTMR_CSR_TIE_MASK | \
+                             LPTMR_CSR_TPS(FREQ_TPS_ALT2))
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static volatile INT32U freqEdges;       /* Edges in completed compare periods */
+static INT32U freqCmr;                  /* Compare value in use */
+static INT8U freqRecip;                 /* Reciprocal mode */
+static INT32U freqGateCyc;              /* Gate in core cycles */
+static INT32U freqIdleMax;              /* Gates without an edge before 0Hz */
+static INT32U freqIdle;                 /* Gates since the last reciprocal interrupt */
+static INT32U freqLastEdges;            /* freqEdges at the last result */
+static INT32U freqLastTs;               /* Time stamp of the last result */
+static INT8U freqHaveLast;              /* freqLastEdges/Ts are valid */
+static volatile INT32U freqResEdges;    /* Latest raw result */
+static volatile INT32U freqResCyc;
+static volatile INT8U freqResRecip;
+static volatile INT8U freqResNew;
+
+static void freqRestart(INT32U cmr, INT8U recip);
+static void freqPublish(INT32U edges, INT32U cycles);
+
+/****************************************************************************************
+* FreqStart() - Starts measuring, gated at first.
+*    Parameters: gate_ms is the gate time, FREQ_GATE_MIN_MS to FREQ_GATE_MAX_MS
+****************************************************************************************/
+void FreqStart(INT32U gate_ms){
+    SIM->SCGC5 |= SIM_SCGC5_LPTMR_MASK;
+    SIM->SCGC6 |= SIM_SCGC6_PIT_MASK;
+    PinConfig(PIN_PORTC, FREQ_PIN, FREQ_MUX_LPTMR, 0, PIN_OPT_NONE);
+
+    freqGateCyc = (SystemCoreClock / FREQ_MS_PER_S) * gate_ms;
+    freqIdleMax = (gate_ms < FREQ_IDLE_MS) ? (FREQ_IDLE_MS / gate_ms) : 1U;
+    freqResNew = FALSE;
+    LPTMR0->CSR = 0;
+    LPTMR0->PSR = LPTMR_PSR_PCS(FREQ_PCS_LPO) | LPTMR_PSR_PBYP_MASK;
+    freqRestart(FREQ_CMR_TOP, FALSE);
+
+    PIT->MCR = 0;
+    PIT->CHANNEL[FREQ_PIT_CH].TCTRL = 0;
+    PIT->CHANNEL[FREQ_PIT_CH].TFLG = PIT_TFLG_TIF_MASK;
+    PIT->CHANNEL[FREQ_PIT_CH].LDVAL = ((K65TWR_BusClock() / FREQ_MS_PER_S) * gate_ms) - 1U;
+    PIT->CHANNEL[FREQ_PIT_CH].TCTRL = PIT_TCTRL_TIE_MASK | PIT_TCTRL_TEN_MASK;
+
+    NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+    NVIC_ClearPendingIRQ(PIT1_IRQn);
+    NVIC_EnableIRQ(LPTMR0_IRQn);
+    NVIC_EnableIRQ(PIT1_IRQn);
+}
+
+/****************************************************************************************
+* FreqStop() - Stops LPTMR0 and PIT1.
+****************************************************************************************/
+void FreqStop(void){
+    NVIC_DisableIRQ(PIT1_IRQn);
+    NVIC_DisableIRQ(LPTMR0_IRQn);
+    PIT->CHANNEL[FREQ_PIT_CH].TCTRL = 0;
+    PIT->CHANNEL[FREQ_PIT_CH].TFLG = PIT_TFLG_TIF_MASK;
+    LPTMR0->CSR = LPTMR_CSR_TCF_MASK;
+    NVIC_ClearPendingIRQ(LPTMR0_IRQn);
+    NVIC_ClearPendingIRQ(PIT1_IRQn);
+}
+
+/****************************************************************************************
+* FreqGet() - Takes the latest result.
+*    Parameters: *res is filled in if there is a new result
+*    return: TRUE if there was a new result since the last call
+****************************************************************************************/
+INT8U FreqGet(FREQ_RESULT *res){
+    INT32U edges;
+    INT32U cycles;
+    INT64U mhz;
+    INT8U got = FALSE;
+
+    __disable_irq();
+    if(freqResNew != FALSE){
+        edges = freqResEdges;
+        cycles = freqResCyc;
+        res->recip = freqResRecip;
+        freqResNew = FALSE;
+        got = TRUE;
+    }else{
+    }
+    __enable_irq();
+    if(got != FALSE){
+        mhz = (cycles != 0) ?
+              (((INT64U)edges * SystemCoreClock * FREQ_MS_PER_S) + (cycles / 2U)) / cycles : 0U;
+        res->hz = (INT32U)(mhz / FREQ_MS_PER_S);
+        res->milli = (INT16U)(mhz % FREQ_MS_PER_S);
+        res->edges = edges;
+    }else{
+    }
+    return got;
+}
+
+/**********************************************************************************
+* PIT1_IRQHandler()
+*
+* Description:  ends a gate. In gated mode reads the edge count and publishes
+*               the gate's edges and length, then moves to reciprocal mode if
+*               there were too few. In reciprocal mode only counts gates
+*               without an edge.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+void PIT1_IRQHandler(void){
+    LOAD_ISR_ENTRY();
+    INT32U now = TS_GET();
+    INT32U cnt;
+    INT32U edges;
+
+    PIT->CHANNEL[FREQ_PIT_CH].TFLG = PIT_TFLG_TIF_MASK;
+    if(freqRecip == FALSE){
+        LPTMR0->CNR = 0;                /* Write latches the count for reading */
+        cnt = LPTMR0->CNR;
+        if(((LPTMR0->CSR & LPTMR_CSR_TCF_MASK) != 0) && (cnt < (FREQ_CMR_TOP / 2U))){
+            /* Wrapped, the LPTMR interrupt has not added it yet */
+            cnt += FREQ_CMR_TOP + 1U;
+        }else{
+        }
+        cnt += freqEdges;
+        edges = cnt - freqLastEdges;
+        freqPublish(edges, now - freqLastTs);
+        freqLastEdges = cnt;
+        freqLastTs = now;
+        if(edges < FREQ_RECIP_EDGES){
+            freqRestart((edges > 1U) ? (edges - 1U) : 0U, TRUE);
+        }else{
+        }
+    }else{
+        freqIdle++;
+        if(freqIdle >= freqIdleMax){
+            freqPublish(0, freqGateCyc);
+            freqRestart(0, TRUE);
+        }else{
+        }
+    }
+    LOAD_ISR_EXIT();
+}
+
+/**********************************************************************************
+* LPTMR0_IRQHandler()
+*
+* Description:  adds a compare period's edges. In reciprocal mode publishes
+*               the edges and time since the last interrupt and sets N for
+*               the next period, or goes back to gated mode.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+void LPTMR0_IRQHandler(void){
+    LOAD_ISR_ENTRY();
+    INT32U now = TS_GET();
+    INT32U edges;
+    INT32U cycles;
+    INT32U n;
+
+    freqEdges += freqCmr + 1U;
+    if(freqRecip != FALSE){
+        freqIdle = 0;
+        edges = freqEdges - freqLastEdges;
+        cycles = now - freqLastTs;
+        if(freqHaveLast != FALSE){
+            freqPublish(edges, cycles);
+            /* Edges that would fill one gate at this rate */
+            n = (INT32U)(((INT64U)edges * freqGateCyc) / cycles);
+        }else{
+            n = freqCmr + 1U;
+        }
+        freqLastEdges = freqEdges;
+        freqLastTs = now;
+        freqHaveLast = TRUE;
+        if(n >= (2U * FREQ_RECIP_EDGES)){
+            freqRestart(FREQ_CMR_TOP, FALSE);
+        }else{
+            /* TCF is still set, so the compare may be written */
+            freqCmr = (n > 1U) ? (n - 1U) : 0U;
+            LPTMR0->CMR = freqCmr;
+            LPTMR0->CSR = FREQ_CSR | LPTMR_CSR_TCF_MASK;
+        }
+    }else{
+        LPTMR0->CSR = FREQ_CSR | LPTMR_CSR_TCF_MASK;
+    }
+    LOAD_ISR_EXIT();
+}
+
+/****************************************************************************************
+* freqRestart() - Restarts the LPTMR count from zero with a new compare value.
+*                 Gated mode starts its first gate now, reciprocal mode waits
+*                 for the first interrupt before it times anything.
+****************************************************************************************/
+static void freqRestart(INT32U cmr, INT8U recip){
+    LPTMR0->CSR = LPTMR_CSR_TCF_MASK;   /* TEN off resets the counter */
+    LPTMR0->CMR = cmr;
+    freqCmr = cmr;
+    freqRecip = recip;
+    freqEdges = 0;
+    freqLastEdges = 0;
+    freqLastTs = TS_GET();
+    freqHaveLast = (INT8U)(recip == FALSE);
+    freqIdle = 0;
+    LPTMR0->CSR = FREQ_CSR;
+}
+
+/****************************************************************************************
+* freqPublish() - Hands a raw result to FreqGet().
+****************************************************************************************/
+static void freqPublish(INT32U edges, INT32U cycles){
+    freqResEdges = edges;
+    freqResCyc = cycles;
+    freqResRecip = freqRecip;
+    freqResNew = TRUE;
+}
@@ -0,0 +1,52 @@
+/****************************************************************************************
+* FreqMeter.h - Gated and reciprocal frequency meter on LPTMR0.
+*
+*   Pulses go to PTC5 (LPTMR0_ALT2), where LPTMR0 counts every rising edge in
+*   hardware. PIT1 ends a gate every gate_ms and the edges of the gate are
+*   divided by its length in core cycles. When a gate holds fewer than
+*   FREQ_RECIP_EDGES edges the meter switches to reciprocal measurement: the
+*   LPTMR compare interrupt comes every N edges, with N picked so N edges take
+*   about one gate, and the time of N edges gives the frequency. It switches
+*   back once N reaches twice FREQ_RECIP_EDGES.
+*
+*   LPTMR0 is shared with the clock switching code, so the meter must be
+*   stopped before the clock profile is changed.
+*
+****************************************************************************************/
+#ifndef FREQ_INCL
+#define FREQ_INCL
+
+#define FREQ_GATE_MIN_MS    10U
+#define FREQ_GATE_MAX_MS    10000U
+#define FREQ_GATE_DEF_MS    1000U
+#define FREQ_RECIP_EDGES    1000U   /* Gated below this many edges per gate */
+
+typedef struct{
+    INT32U hz;                      /* Whole Hz */
+    INT16U milli;                   /* Thousandths of a Hz */
+    INT8U recip;                    /* TRUE for a reciprocal measurement */
+    INT32U edges;                   /* Edges the result is based on */
+}FREQ_RESULT;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* FreqStart() - Starts measuring, gated at first.
+*    Parameters: gate_ms is the gate time, FREQ_GATE_MIN_MS to FREQ_GATE_MAX_MS
+****************************************************************************************/
+void FreqStart(INT32U gate_ms);
+
+/****************************************************************************************
+* FreqStop() - Stops LPTMR0 and PIT1.
+****************************************************************************************/
+void FreqStop(void);
+
+/****************************************************************************************
+* FreqGet() - Takes the latest result.
+*    Parameters: *res is filled in if there is a new result
+*    return: TRUE if there was a new result since the last call
+****************************************************************************************/
+INT8U FreqGet(FREQ_RESULT *res);
+
+#endif
@@ -0,0 +1,340 @@
+/****************************************************************************************
+* History.c - Compressed in-RAM history of the counters.
+*
+*   A block header holds the value and delta of the entry before its first
+*   one, so every block decodes on its own and the oldest can be dropped
+*   without touching the rest. A counts entry's value is the running total of
+*   the hardware counter, which makes its delta the interval's count. Blocks
+*   are numbered as they are opened so a reader can tell when the block under
+*   it was reused.
+*
+*   The clock is the DWT cycle counter extended to 64 bits in microseconds.
+*   Cycles are converted at the clock rate of each pass, so it stays right
+*   across clk changes as long as a pass is under 23.8s.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "TimeStamp.h"
+#include "Counter.h"
+#include "History.h"
+
+#define HIST_US_PER_S       1000000U
+#define HIST_HDR_BYTES      28U
+#define HIST_DATA_BYTES     (HIST_BLK_BYTES - HIST_HDR_BYTES)
+#define HIST_VARINT_MAX     10U     /* Bytes in the longest 64 bit varint */
+
+typedef struct{
+    INT64U prev;                    /* Value of the entry before the first */
+    INT64S delta;                   /* Delta of the entry before the first */
+    INT32U t0;                      /* Interval number of the first entry */
+    INT32U seq;                     /* Order the block was opened in */
+    INT16U n;                       /* Entries */
+    INT16U used;                    /* Data bytes */
+    INT8U data[HIST_DATA_BYTES];
+}HIST_BLOCK;
+
+typedef struct{
+    HIST_BLOCK blk[HIST_BLOCKS];
+    INT16U head;                    /* Block entries are added to */
+    INT16U nblk;                    /* Blocks in use */
+    INT32U seq;                     /* seq of the head block */
+    INT64U prev;                    /* Last value added */
+    INT64S delta;                   /* Last delta added */
+}HIST_SER;
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static HIST_SER histSer[HIST_NUM_SER];
+static INT64U histUs;                   /* Microseconds since HistInit() */
+static INT32U histCycRem;               /* Cycles not yet in histUs */
+static INT32U histLastTs;               /* Time stamp at the last pass */
+static INT64U histNextUs;               /* End of the open counts interval */
+static INT32U histInterval;             /* Number of the open counts interval */
+static INT64U histTotal;                /* Hardware count, extended to 64 bits */
+static INT32U histCntLast;              /* CntGet() at the last pass */
+static INT32U histSeen;                 /* CntPresses() already taken */
+
+static void histReset(INT8U ser, INT64U first, INT32U t0);
+static void histAdd(INT8U ser, INT64U val, INT32U t);
+static INT16U histOldest(const HIST_SER *ser);
+
+/****************************************************************************************
+* HistInit() - Empties both series and starts the clock. Needs TSInit() and
+*              CntInit().
+****************************************************************************************/
+void HistInit(void){
+    histUs = 0;
+    histCycRem = 0;
+    histLastTs = TS_GET();
+    histCntLast = CntGet(CNT_HARDWARE);
+    histTotal = 0;
+    histSeen = CntPresses();
+    HistClear();
+}
+
+/****************************************************************************************
+* HistTask() - Keeps the microsecond clock, closes counts intervals and takes
+*              new presses. Call once per main loop pass.
+****************************************************************************************/
+void HistTask(void){
+    INT32U now = TS_GET();
+    INT32U cyc_us = SystemCoreClock / HIST_US_PER_S;
+    INT32U cnt;
+    INT32U presses;
+    INT32U down;
+    INT32U up;
+
+    histCycRem += now - histLastTs;
+    histLastTs = now;
+    histUs += histCycRem / cyc_us;
+    histCycRem %= cyc_us;
+
+    cnt = CntGet(CNT_HARDWARE);
+    histTotal += cnt - histCntLast;
+    histCntLast = cnt;
+    while(histUs >= histNextUs){
+        /* After a stall the whole stall's count goes to the first interval */
+        histAdd(HIST_COUNTS, histTotal, histInterval);
+        histInterval++;
+        histNextUs += (INT64U)HIST_INTERVAL_S * HIST_US_PER_S;
+    }
+
+    presses = CntPresses();
+    if(presses != histSeen){
+        histSeen = presses;
+        CntLastPress(&down, &up);
+        histAdd(HIST_EVENTS, histUs - ((now - down) / cyc_us), 0);
+    }else{
+    }
+}
+
+/****************************************************************************************
+* HistNowUs() - The history clock, microseconds since HistInit(). Unlike the
+*               DWT time stamps it does not wrap.
+****************************************************************************************/
+INT64U HistNowUs(void){
+    INT32U cyc_us = SystemCoreClock / HIST_US_PER_S;
+    /* Includes the cycles since the last HistTask() pass */
+    return histUs + ((histCycRem + (TS_GET() - histLastTs)) / cyc_us);
+}
+
+/****************************************************************************************
+* HistIterStart() - Points an iterator at the oldest entry of a series.
+*    Parameters: ser is HIST_COUNTS or HIST_EVENTS
+****************************************************************************************/
+void HistIterStart(INT8U ser, HIST_ITER *it){
+    const HIST_SER *s = &histSer[ser];
+    const HIST_BLOCK *b;
+    it->ser = ser;
+    it->blk = histOldest(s);
+    b = &s->blk[it->blk];
+    it->seq = b->seq;
+    it->pos = 0;
+    it->k = 0;
+    it->v = b->prev;
+    it->d = b->delta;
+}
+
+/****************************************************************************************
+* HistNext() - Reads the next entry. If the block being read was reused since
+*              the last call the iterator skips ahead to the oldest block.
+*    Parameters: *sec is set to the entry's time in seconds
+*                *val is set to the interval's count for HIST_COUNTS or the
+*                time stamp in microseconds for HIST_EVENTS
+*    return: TRUE if an entry was read, FALSE at the newest entry
+****************************************************************************************/
+INT8U HistNext(HIST_ITER *it, INT32U *sec, INT64U *val){
+    const HIST_SER *s = &histSer[it->ser];
+    const HIST_BLOCK *b = &s->blk[it->blk];
+    INT64U z = 0;
+    INT8U shift = 0;
+    INT8U byte;
+    INT8U got = FALSE;
+
+    if(b->seq != it->seq){
+        HistIterStart(it->ser, it);
+        b = &s->blk[it->blk];
+    }else{
+    }
+    if((it->k >= b->n) && (it->blk != s->head)){
+        it->blk = (INT16U)((it->blk + 1U) % HIST_BLOCKS);
+        it->seq++;
+        b = &s->blk[it->blk];
+        if(b->seq != it->seq){
+            HistIterStart(it->ser, it);
+            b = &s->blk[it->blk];
+        }else{
+            it->pos = 0;
+            it->k = 0;
+            it->v = b->prev;
+            it->d = b->delta;
+        }
+    }else{
+    }
+    if(it->k < b->n){
+        do{
+            byte = b->data[it->pos];
+            it->pos++;
+            z |= (INT64U)(byte & 0x7FU) << shift;
+            shift += 7U;
+        }while((byte & 0x80U) != 0);
+        it->d += (INT64S)(z >> 1) ^ -(INT64S)(z & 1U);
+        it->v += (INT64U)it->d;
+        if(it->ser == HIST_COUNTS){
+            *sec = (b->t0 + it->k) * HIST_INTERVAL_S;
+            *val = (INT64U)it->d;
+        }else{
+            *sec = (INT32U)(it->v / HIST_US_PER_S);
+            *val = it->v;
+        }
+        it->k++;
+        got = TRUE;
+    }else{
+    }
+    return got;
+}
+
+/****************************************************************************************
+* HistCounts() - Total of the last secs closed counts intervals.
+*    Parameters: *covered is set to the seconds actually held, which is less
+*                than secs if the history is shorter
+****************************************************************************************/
+INT64U HistCounts(INT32U secs, INT32U *covered){
+    HIST_ITER it;
+    INT32U sec;
+    INT64U val;
+    INT64U total = 0;
+    INT32U from;
+    INT32U n = 0;
+    /* Closed intervals end at histInterval, count back secs from there */
+    from = ((secs / HIST_INTERVAL_S) < histInterval) ?
+           ((histInterval - (secs / HIST_INTERVAL_S)) * HIST_INTERVAL_S) : 0U;
+    HistIterStart(HIST_COUNTS, &it);
+    while(HistNext(&it, &sec, &val) != FALSE){
+        if(sec >= from){
+            total += val;
+            n++;
+        }else{
+        }
+    }
+    *covered = n * HIST_INTERVAL_S;
+    return total;
+}
+
+/****************************************************************************************
+* HistInfo() - Fill level of a series.
+****************************************************************************************/
+void HistInfo(INT8U ser, HIST_INFO *info){
+    HIST_ITER it;
+    INT32U sec;
+    INT64U val;
+    const HIST_SER *s = &histSer[ser];
+    INT16U i;
+    INT16U blk;
+
+    info->blocks = s->nblk;
+    info->entries = 0;
+    info->bytes = 0;
+    blk = histOldest(s);
+    for(i = 0; i < s->nblk; i++){
+        info->entries += s->blk[blk].n;
+        info->bytes += s->blk[blk].used;
+        blk = (INT16U)((blk + 1U) % HIST_BLOCKS);
+    }
+    info->first = 0;
+    info->last = 0;
+    HistIterStart(ser, &it);
+    if(HistNext(&it, &sec, &val) != FALSE){
+        info->first = sec;
+        info->last = sec;
+        while(HistNext(&it, &sec, &val) != FALSE){
+            info->last = sec;
+        }
+    }else{
+    }
+}
+
+/****************************************************************************************
+* HistClear() - Empties both series, the clock keeps running.
+****************************************************************************************/
+void HistClear(void){
+    histReset(HIST_COUNTS, histTotal, histInterval);
+    histReset(HIST_EVENTS, histUs, 0);
+    histNextUs = histUs + ((INT64U)HIST_INTERVAL_S * HIST_US_PER_S);
+}
+
+/****************************************************************************************
+* histReset() - Empties a series and opens its first block.
+*    Parameters: first is the value deltas start from, t0 the number of the
+*                first interval
+****************************************************************************************/
+static void histReset(INT8U ser, INT64U first, INT32U t0){
+    HIST_SER *s = &histSer[ser];
+    HIST_BLOCK *b = &s->blk[0];
+    s->head = 0;
+    s->nblk = 1;
+    s->seq++;
+    s->prev = first;
+    s->delta = 0;
+    b->prev = first;
+    b->delta = 0;
+    b->t0 = t0;
+    b->seq = s->seq;
+    b->n = 0;
+    b->used = 0;
+}
+
+/****************************************************************************************
+* histAdd() - Encodes one entry, opening the next block if it does not fit.
+*    Parameters: val is the entry's value, t the number of its interval
+****************************************************************************************/
+static void histAdd(INT8U ser, INT64U val, INT32U t){
+    HIST_SER *s = &histSer[ser];
+    HIST_BLOCK *b = &s->blk[s->head];
+    INT8U buf[HIST_VARINT_MAX];
+    INT8U len = 0;
+    INT8U i;
+    INT64S delta = (INT64S)(val - s->prev);
+    INT64S dod = delta - s->delta;
+    INT64U z = ((INT64U)dod << 1) ^ (INT64U)(dod >> 63);
+
+    while(z >= 0x80U){
+        buf[len] = (INT8U)(z | 0x80U);
+        z >>= 7;
+        len++;
+    }
+    buf[len] = (INT8U)z;
+    len++;
+
+    if((b->used + len) > HIST_DATA_BYTES){
+        s->head = (INT16U)((s->head + 1U) % HIST_BLOCKS);
+        if(s->nblk < HIST_BLOCKS){
+            s->nblk++;
+        }else{
+        }
+        s->seq++;
+        b = &s->blk[s->head];
+        b->prev = s->prev;
+        b->delta = s->delta;
+        b->t0 = t;
+        b->seq = s->seq;
+        b->n = 0;
+        b->used = 0;
+    }else{
+    }
+    for(i = 0; i < len; i++){
+        b->data[b->used + i] = buf[i];
+    }
+    b->used += len;
+    b->n++;
+    s->prev = val;
+    s->delta = delta;
+}
+
+/****************************************************************************************
+* histOldest() - Index of the oldest block of a series.
+****************************************************************************************/
+static INT16U histOldest(const HIST_SER *ser){
+    return (INT16U)((ser->head + HIST_BLOCKS + 1U - ser->nblk) % HIST_BLOCKS);
+}
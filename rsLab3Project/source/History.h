@@ -0,0 +1,96 @@
+/****************************************************************************************
+* History.h - Compressed in-RAM history of the counters.
+*
+*   Two series are kept: HIST_COUNTS holds how many edges the hardware counter
+*   took in each HIST_INTERVAL_S interval and HIST_EVENTS holds the time stamp
+*   of each debounced SW2 press in microseconds since HistInit(). Each series
+*   is a ring of fixed-size blocks. Entries are stored as the zigzag varint of
+*   the change in their delta (delta-of-delta), so a steady rate or an idle
+*   interval takes one byte. When a series is full its oldest block is reused.
+*
+****************************************************************************************/
+#ifndef HIST_INCL
+#define HIST_INCL
+
+#define HIST_COUNTS         0U      /* Counts per interval */
+#define HIST_EVENTS         1U      /* Press time stamps */
+#define HIST_NUM_SER        2U
+
+#define HIST_INTERVAL_S     1U      /* Length of a counts interval */
+#define HIST_BLK_BYTES      256U    /* Block size, header included */
+#define HIST_BLOCKS         64U     /* Blocks per series */
+
+/* Iterator over the entries of one series, oldest first */
+typedef struct{
+    INT8U ser;
+    INT16U blk;                     /* Block being read */
+    INT32U seq;                     /* Sequence number that block had */
+    INT16U pos;                     /* Next data byte */
+    INT16U k;                       /* Entries read from the block */
+    INT64U v;                       /* Value of the last entry */
+    INT64S d;                       /* Delta of the last entry */
+}HIST_ITER;
+
+typedef struct{
+    INT16U blocks;                  /* Blocks in use */
+    INT32U entries;
+    INT32U bytes;                   /* Encoded data bytes */
+    INT32U first;                   /* Seconds of the oldest entry */
+    INT32U last;                    /* Seconds of the newest entry */
+}HIST_INFO;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* HistInit() - Empties both series and starts the clock. Needs TSInit() and
+*              CntInit().
+****************************************************************************************/
+void HistInit(void);
+
+/****************************************************************************************
+* HistTask() - Keeps the microsecond clock, closes counts intervals and takes
+*              new presses. Call once per main loop pass.
+****************************************************************************************/
+void HistTask(void);
+
+/****************************************************************************************
+* HistNowUs() - The history clock, microseconds since HistInit(). Unlike the
+*               DWT time stamps it does not wrap.
+****************************************************************************************/
+INT64U HistNowUs(void);
+
+/****************************************************************************************
+* HistIterStart() - Points an iterator at the oldest entry of a series.
+*    Parameters: ser is HIST_COUNTS or HIST_EVENTS
+****************************************************************************************/
+void HistIterStart(INT8U ser, HIST_ITER *it);
+
+/****************************************************************************************
+* HistNext() - Reads the next entry. If the block being read was reused since
+*              the last call the iterator skips ahead to the oldest block.
+*    Parameters: *sec is set to the entry's time in seconds
+*                *val is set to the interval's count for HIST_COUNTS or the
+*                time stamp in microseconds for HIST_EVENTS
+*    return: TRUE if an entry was read, FALSE at the newest entry
+****************************************************************************************/
+INT8U HistNext(HIST_ITER *it, INT32U *sec, INT64U *val);
+
+/****************************************************************************************
+* HistCounts() - Total of the last secs closed counts intervals.
+*    Parameters: *covered is set to the seconds actually held, which is less
+*                than secs if the history is shorter
+****************************************************************************************/
+INT64U HistCounts(INT32U secs, INT32U *covered);
+
+/****************************************************************************************
+* HistInfo() - Fill level of a series.
+****************************************************************************************/
+void HistInfo(INT8U ser, HIST_INFO *info);
+
+/****************************************************************************************
+* HistClear() - Empties both series, the clock keeps running.
+****************************************************************************************/
+void HistClear(void);
+
+#endif
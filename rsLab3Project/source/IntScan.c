@@ -0,0 +1,243 @@
+/****************************************************************************************
+* IntScan.c - Region table driven memory integrity scanner.
+*
+*   DMA engine: eDMA channel SCAN_DMA_CH is routed to an always-on DMAMUX slot
+*   so it runs its whole major loop without further requests, writing one word
+*   per read into CRC0 DATA. The part of a region that is not a whole number of
+*   minor loops is written to CRC0 by the CPU when the DMA segment is done.
+*
+*   CPU engine: at most SCAN_CPU_STEP bytes per ScanTask() call with the
+*   software kernel of the region's algorithm, so the main loop keeps running.
+*
+*   SRAM_L only holds the RAMFUNC code, which does not change after startup,
+*   so a changed sum means the code was overwritten. FlexNVM is only present
+*   on FX parts, the FN part on the K65TWR has none.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "MK65F18_features.h"
+#include "TimeStamp.h"
+#include "ChkSum.h"
+#include "Persist.h"
+#include "IntScan.h"
+
+#define SCAN_ENG_CPU        0U
+#define SCAN_ENG_DMA        1U
+#define SCAN_NUM_ENG        2U
+
+#define SCAN_NONE           0xFFU           /* No region in progress */
+#define SCAN_CPU_STEP       1024U           /* Bytes per ScanTask() for the CPU */
+#define SCAN_DMA_CH         0U
+#define SCAN_DMA_SLOT       60U             /* DMAMUX always-on source */
+#define SCAN_DMA_MINOR      128U            /* Bytes per minor loop */
+#define SCAN_DMA_MAX_LOOPS  0x7FFFU         /* CITER without channel linking */
+#define SCAN_DMA_WORD       2U              /* ATTR size code for 32 bits */
+
+/* The counter log changes. No checkpoint runs during a scan, reads of its block would collide */
+#define SCAN_PFLASH_HIGH    (PERSIST_BASE - 1U)
+#define SCAN_FLEXNVM_HIGH   (FSL_FEATURE_FLASH_FLEX_NVM_START_ADDRESS + \
+                             (FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_SIZE * \
+                              FSL_FEATURE_FLASH_FLEX_NVM_BLOCK_COUNT) - 1U)
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+typedef struct{
+    const INT8C *name;
+    INT32U low;
+    INT32U high;
+    INT8U alg;                      /* Must have a hardware kernel for SCAN_ENG_DMA */
+    INT8U engine;
+}SCAN_REGION;
+
+typedef struct{
+    INT8U next;                     /* Table index to look for the next region from */
+    INT8U cur;                      /* Region in progress or SCAN_NONE */
+    INT8U dma;                      /* A DMA segment is running */
+    const INT8U *addr;              /* Next byte not yet handed to an engine */
+    INT32U left;                    /* Bytes not yet handed to an engine */
+    INT32U start;                   /* Time stamp when the region started */
+    CS_CTX ctx;
+}SCAN_JOB;
+
+static const SCAN_REGION scanRegions[] = {
+    {"pflash",  0x00000000U, SCAN_PFLASH_HIGH, CS_ALG_CRC32, SCAN_ENG_DMA},
+#if FSL_FEATURE_FLASH_HAS_FLEX_NVM
+    {"flexnvm", FSL_FEATURE_FLASH_FLEX_NVM_START_ADDRESS, SCAN_FLEXNVM_HIGH,
+                                             CS_ALG_CRC32, SCAN_ENG_DMA},
+#endif
+    {"sram_l",  0x1FFF0000U, 0x1FFFFFFFU,    CS_ALG_SUM16, SCAN_ENG_CPU},
+    {"flexram", 0x14000000U, 0x14000FFFU,    CS_ALG_FLETCHER32, SCAN_ENG_CPU},
+};
+#define SCAN_NUM_REGIONS    ((INT8U)(sizeof(scanRegions)/sizeof(scanRegions[0])))
+
+static SCAN_JOB scanJob[SCAN_NUM_ENG];
+static INT8U scanRunning = FALSE;
+
+static void scanNextRegion(INT8U engine);
+static INT8U scanStep(INT8U engine);
+static void scanDmaSegment(SCAN_JOB *job);
+
+/****************************************************************************************
+* ScanStart() - Starts scanning every region in the table. Does nothing if a
+*               scan is already running.
+*    return: number of regions in the table
+****************************************************************************************/
+INT8U ScanStart(void){
+    INT8U engine;
+    if(scanRunning == FALSE){
+        SIM->SCGC6 |= SIM_SCGC6_DMAMUX_MASK;
+        SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+        for(engine = 0; engine < SCAN_NUM_ENG; engine++){
+            scanJob[engine].next = 0;
+            scanNextRegion(engine);
+        }
+        scanRunning = TRUE;
+    }else{
+    }
+    return SCAN_NUM_REGIONS;
+}
+
+/****************************************************************************************
+* ScanTask() - Advances both engines. Never blocks. Call once per main loop pass.
+*    return: TRUE when a region finished, *res holds its result
+****************************************************************************************/
+INT8U ScanTask(SCAN_RESULT *res){
+    INT8U engine;
+    INT8U done = FALSE;
+    SCAN_JOB *job;
+    const SCAN_REGION *reg;
+
+    if(scanRunning != FALSE){
+        for(engine = 0; engine < SCAN_NUM_ENG; engine++){
+            job = &scanJob[engine];
+            /* Only one result per call, the other engine reports next time */
+            if((job->cur != SCAN_NONE) && (done == FALSE) && (scanStep(engine) != FALSE)){
+                reg = &scanRegions[job->cur];
+                res->name = reg->name;
+                res->low = reg->low;
+                res->high = reg->high;
+                res->alg = reg->alg;
+                res->err = FALSE;
+                if((engine == SCAN_ENG_DMA) && ((DMA0->ERR & (1U << SCAN_DMA_CH)) != 0)){
+                    DMA0->CERR = SCAN_DMA_CH;
+                    res->err = TRUE;
+                }else{
+                }
+                res->sum = CsFinish(&job->ctx);
+                res->cycles = TS_GET() - job->start;
+                done = TRUE;
+                scanNextRegion(engine);
+            }else{
+            }
+        }
+        if((scanJob[SCAN_ENG_CPU].cur == SCAN_NONE) && (scanJob[SCAN_ENG_DMA].cur == SCAN_NONE)){
+            scanRunning = FALSE;
+        }else{
+        }
+    }else{
+    }
+    return done;
+}
+
+/****************************************************************************************
+* ScanBusy() - TRUE while a scan is running.
+****************************************************************************************/
+INT8U ScanBusy(void){
+    return scanRunning;
+}
+
+/****************************************************************************************
+* scanNextRegion() - Starts the next table region for engine, or leaves the
+*                    engine idle if there are none left. Private.
+****************************************************************************************/
+static void scanNextRegion(INT8U engine){
+    SCAN_JOB *job = &scanJob[engine];
+    const SCAN_REGION *reg;
+    INT8U kern = (engine == SCAN_ENG_DMA) ? CS_KERN_HW : CS_KERN_SW;
+
+    job->cur = SCAN_NONE;
+    while((job->next < SCAN_NUM_REGIONS) && (job->cur == SCAN_NONE)){
+        reg = &scanRegions[job->next];
+        if((reg->engine == engine) && (CsStart(&job->ctx, reg->alg, kern) == 0)){
+            job->cur = job->next;
+            job->addr = (const INT8U *)reg->low;
+            job->left = reg->high - reg->low + 1U;
+            job->dma = FALSE;
+            job->start = TS_GET();
+        }else{
+        }
+        job->next++;
+    }
+    if((engine == SCAN_ENG_DMA) && (job->cur != SCAN_NONE)){
+        scanDmaSegment(job);
+    }else{
+    }
+}
+
+/****************************************************************************************
+* scanStep() - Advances engine's region. Private.
+*    return: TRUE when every byte of the region has been handed to its kernel
+****************************************************************************************/
+static INT8U scanStep(INT8U engine){
+    SCAN_JOB *job = &scanJob[engine];
+    INT32U len;
+    INT8U done = FALSE;
+
+    if(engine == SCAN_ENG_CPU){
+        len = (job->left > SCAN_CPU_STEP) ? SCAN_CPU_STEP : job->left;
+        CsUpdate(&job->ctx, job->addr, len);
+        job->addr += len;
+        job->left -= len;
+        done = (job->left == 0) ? TRUE : FALSE;
+    }else if((DMA0->ERR & (1U << SCAN_DMA_CH)) != 0){
+        DMA0->CERQ = SCAN_DMA_CH;
+        job->dma = FALSE;
+        done = TRUE;
+    }else if((job->dma == FALSE) || ((DMA0->TCD[SCAN_DMA_CH].CSR & DMA_CSR_DONE_MASK) != 0)){
+        DMA0->CDNE = SCAN_DMA_CH;
+        job->dma = FALSE;
+        if(job->left >= SCAN_DMA_MINOR){
+            scanDmaSegment(job);
+        }else{
+            /* Leftover bytes, CRC0 still holds the running CRC */
+            CsUpdate(&job->ctx, job->addr, job->left);
+            job->left = 0;
+            done = TRUE;
+        }
+    }else{
+    }
+    return done;
+}
+
+/****************************************************************************************
+* scanDmaSegment() - Starts DMA of as many whole minor loops of the region as a
+*                    major loop can hold. Private.
+****************************************************************************************/
+static void scanDmaSegment(SCAN_JOB *job){
+    INT32U loops = job->left / SCAN_DMA_MINOR;
+    if(loops > SCAN_DMA_MAX_LOOPS){
+        loops = SCAN_DMA_MAX_LOOPS;
+    }else{
+    }
+    if(loops > 0){
+        DMAMUX->CHCFG[SCAN_DMA_CH] = 0;
+        DMA0->TCD[SCAN_DMA_CH].SADDR = (INT32U)job->addr;
+        DMA0->TCD[SCAN_DMA_CH].SOFF = 4U;
+        DMA0->TCD[SCAN_DMA_CH].ATTR = DMA_ATTR_SSIZE(SCAN_DMA_WORD) | DMA_ATTR_DSIZE(SCAN_DMA_WORD);
+        DMA0->TCD[SCAN_DMA_CH].NBYTES_MLNO = SCAN_DMA_MINOR;
+        DMA0->TCD[SCAN_DMA_CH].SLAST = 0;
+        DMA0->TCD[SCAN_DMA_CH].DADDR = (INT32U)&CRC0->DATA;
+        DMA0->TCD[SCAN_DMA_CH].DOFF = 0;
+        DMA0->TCD[SCAN_DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(loops);
+        DMA0->TCD[SCAN_DMA_CH].DLAST_SGA = 0;
+        DMA0->TCD[SCAN_DMA_CH].CSR = DMA_CSR_DREQ_MASK;     /* Stop requests when done */
+        DMA0->TCD[SCAN_DMA_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(loops);
+        job->addr += loops * SCAN_DMA_MINOR;
+        job->left -= loops * SCAN_DMA_MINOR;
+        job->dma = TRUE;
+        DMAMUX->CHCFG[SCAN_DMA_CH] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(SCAN_DMA_SLOT);
+        DMA0->SERQ = SCAN_DMA_CH;
+    }else{
+    }
+}
@@ -0,0 +1,48 @@
+/****************************************************************************************
+* IntScan.h - Region table driven memory integrity scanner.
+*
+*   Every region in the table is checksummed as an independent job. Regions
+*   assigned to the DMA engine are fed to CRC0 by eDMA, regions assigned to the
+*   CPU engine are summed in steps from ScanTask(), so one DMA region and one
+*   CPU region are always in progress at the same time. CRC0 belongs to the
+*   scanner while ScanBusy() is TRUE.
+*
+****************************************************************************************/
+#ifndef SCAN_INCL
+#define SCAN_INCL
+
+/****************************************************************************************
+* Types
+****************************************************************************************/
+typedef struct{
+    const INT8C *name;              /* Region name */
+    INT32U low;                     /* First address */
+    INT32U high;                    /* Last address */
+    INT32U sum;
+    INT32U cycles;                  /* Core cycles from region start to result */
+    INT8U alg;                      /* CS_ALG_xxx */
+    INT8U err;                      /* TRUE if a DMA bus error stopped the region */
+}SCAN_RESULT;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* ScanStart() - Starts scanning every region in the table. Does nothing if a
+*               scan is already running.
+*    return: number of regions in the table
+****************************************************************************************/
+INT8U ScanStart(void);
+
+/****************************************************************************************
+* ScanTask() - Advances both engines. Never blocks. Call once per main loop pass.
+*    return: TRUE when a region finished, *res holds its result
+****************************************************************************************/
+INT8U ScanTask(SCAN_RESULT *res);
+
+/****************************************************************************************
+* ScanBusy() - TRUE while a scan is running.
+****************************************************************************************/
+INT8U ScanBusy(void);
+
+#endif
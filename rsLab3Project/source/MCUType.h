@@ -18,7 +18,7 @@
  * Standard types to include
  ********************************************************************************/
 #define APP_TYPE_UCOS_EN    0
-#define APP_TYPE_CMSIS_EN   0
+#define APP_TYPE_CMSIS_EN   0       /* 1 needs libarm_cortexM4lf_math linked */
 #define APP_TYPE_WWU_EN     1
 
 #if APP_TYPE_UCOS_EN
@@ -0,0 +1,152 @@
+/****************************************************************************************
+* MemBench.c - Memory performance measurements.
+*
+*   Sections are copied from the start of flash, which is where data_init()
+*   loads from, into a RAM buffer. Interrupts are masked while each case runs
+*   so only the copy is timed.
+*
+*   The cache bench prints the setting number with the BIOOutDecWord() call it
+*   times. It is one digit and the UART is flushed first, so the time is the
+*   conversion and a single write to an empty transmitter.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "TimeStamp.h"
+#include "MemCfg.h"
+#include "ChkSum.h"
+#include "Counter.h"
+#include "MemBench.h"
+
+#define MB_MAX_BYTES    16384U
+#define MB_NUM_SIZES    6U
+#define MB_SRC_ADDR     0x00000000U     /* Flash, like a real data section */
+#define MB_DIGITS       8U
+#define MB_CS_HIGH      0x0000FFFFU     /* Flash checksummed by the cache bench */
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+/* Startup section initialization, startup_mk65f18.c */
+void data_init(unsigned int romstart, unsigned int start, unsigned int len);
+void bss_init(unsigned int start, unsigned int len);
+
+static void mbDataInitWord(unsigned int romstart, unsigned int start, unsigned int len);
+static void mbBssInitWord(unsigned int start, unsigned int len);
+
+static INT32U mbBuf[MB_MAX_BYTES/4U];
+static const INT32U mbSizes[MB_NUM_SIZES] = {16U, 64U, 256U, 1024U, 4096U, 16384U};
+
+/****************************************************************************************
+* MemBenchInit() - Times the startup data_init() and bss_init() against the
+*                  original one word per iteration loops for several section
+*                  sizes and outputs the cycle counts.
+****************************************************************************************/
+void MemBenchInit(void){
+    INT8U i;
+    INT32U len;
+    INT32U start;
+    INT32U cyc[4];
+
+    BIOPutStrg("Section init cycles");
+    BIOOutCRLF();
+    BIOPutStrg("   bytes data word data LDM bss word  bss STM");
+    BIOOutCRLF();
+    for(i = 0; i < MB_NUM_SIZES; i++){
+        len = mbSizes[i];
+        __disable_irq();
+        start = TS_GET();
+        mbDataInitWord(MB_SRC_ADDR, (unsigned int)mbBuf, len);
+        cyc[0] = TS_GET() - start;
+        start = TS_GET();
+        data_init(MB_SRC_ADDR, (unsigned int)mbBuf, len);
+        cyc[1] = TS_GET() - start;
+        start = TS_GET();
+        mbBssInitWord((unsigned int)mbBuf, len);
+        cyc[2] = TS_GET() - start;
+        start = TS_GET();
+        bss_init((unsigned int)mbBuf, len);
+        cyc[3] = TS_GET() - start;
+        __enable_irq();
+
+        BIOOutDecWord(len, MB_DIGITS);
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[0], 9U);
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[1], 8U);
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[2], 8U);
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[3], 8U);
+        BIOOutCRLF();
+    }
+}
+
+/****************************************************************************************
+* MemBenchCache() - Runs CalcChkSum() over 64KB of flash, one BIOOutDecWord()
+*                   and the flash resident SW2 count handler under every
+*                   MemCfgSet() combination and outputs the cycle counts. The
+*                   setting in effect before the call is restored.
+****************************************************************************************/
+void MemBenchCache(void){
+    INT8U cfg;
+    INT8U prev;
+    INT32U start;
+    INT32U cyc[2];
+    INT32U best;
+    INT32U worst;
+
+    prev = MemCfgGet();
+    BIOPutStrg("Cache and prefetch cycles, L=LMEM F=FMC cache P=prefetch");
+    BIOOutCRLF();
+    BIOPutStrg("cfg     dec   chksum64K  isr best  worst");
+    BIOOutCRLF();
+    for(cfg = 0; cfg < MEMCFG_NUM; cfg++){
+        MemCfgSet(cfg);
+        BIOFlush();
+        start = TS_GET();
+        BIOOutDecWord(cfg, 1U);
+        cyc[0] = TS_GET() - start;
+        __disable_irq();
+        start = TS_GET();
+        (void)CalcChkSum((INT8U *)0, (INT8U *)MB_CS_HIGH);
+        cyc[1] = TS_GET() - start;
+        __enable_irq();
+        best = CntIsrBench(CNT_ISR_COUNT, FALSE, &worst);
+
+        BIOWrite(((cfg & MEMCFG_LMEM) != 0) ? 'L' : '-');
+        BIOWrite(((cfg & MEMCFG_FMC) != 0) ? 'F' : '-');
+        BIOWrite(((cfg & MEMCFG_PREFETCH) != 0) ? 'P' : '-');
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[0], 7U);
+        BIOWrite(' ');
+        BIOOutDecWord(cyc[1], 11U);
+        BIOWrite(' ');
+        BIOOutDecWord(best, 9U);
+        BIOWrite(' ');
+        BIOOutDecWord(worst, 6U);
+        BIOOutCRLF();
+    }
+    MemCfgSet(prev);
+}
+
+/****************************************************************************************
+* mbDataInitWord() - Original data_init(), one word per iteration. Private.
+****************************************************************************************/
+static void mbDataInitWord(unsigned int romstart, unsigned int start, unsigned int len){
+    volatile unsigned int *pulDest = (unsigned int*) start;
+    unsigned int *pulSrc = (unsigned int*) romstart;
+    unsigned int loop;
+    for (loop = 0; loop < len; loop = loop + 4)
+        *pulDest++ = *pulSrc++;
+}
+
+/****************************************************************************************
+* mbBssInitWord() - Original bss_init(), one word per iteration. Private.
+****************************************************************************************/
+static void mbBssInitWord(unsigned int start, unsigned int len){
+    volatile unsigned int *pulDest = (unsigned int*) start;
+    unsigned int loop;
+    for (loop = 0; loop < len; loop = loop + 4)
+        *pulDest++ = 0;
+}
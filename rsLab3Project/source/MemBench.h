@@ -0,0 +1,26 @@
+/****************************************************************************************
+* MemBench.h - Memory performance measurements.
+*
+****************************************************************************************/
+#ifndef MB_INCL
+#define MB_INCL
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* MemBenchInit() - Times the startup data_init() and bss_init() against the
+*                  original one word per iteration loops for several section
+*                  sizes and outputs the cycle counts.
+****************************************************************************************/
+void MemBenchInit(void);
+
+/****************************************************************************************
+* MemBenchCache() - Runs CalcChkSum() over 64KB of flash, one BIOOutDecWord()
+*                   and the flash resident SW2 count handler under every
+*                   MemCfgSet() combination and outputs the cycle counts. The
+*                   setting in effect before the call is restored.
+****************************************************************************************/
+void MemBenchCache(void);
+
+#endif
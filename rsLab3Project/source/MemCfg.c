@@ -0,0 +1,109 @@
+/****************************************************************************************
+* MemCfg.c - Cache and flash prefetch configuration.
+*
+*   The LMEM code cache runs write-back for SRAM_L by default, so it is pushed
+*   before it is invalidated or switched off. Flash is only written through the
+*   FTFE command interface, so the FMC caches never hold dirty data and can
+*   simply be invalidated.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "MemCfg.h"
+
+#define MEMCFG_LMEM_CLEAR   (LMEM_PCCCR_PUSHW0_MASK | LMEM_PCCCR_PUSHW1_MASK | \
+                             LMEM_PCCCR_INVW0_MASK | LMEM_PCCCR_INVW1_MASK)
+#define MEMCFG_LMEM_ON      (LMEM_PCCCR_ENCACHE_MASK | LMEM_PCCCR_ENWRBUF_MASK)
+#define MEMCFG_B01_CACHE    (FMC_PFB01CR_B0ICE_MASK | FMC_PFB01CR_B0DCE_MASK)
+#define MEMCFG_B01_PF       (FMC_PFB01CR_B0IPE_MASK | FMC_PFB01CR_B0DPE_MASK)
+#define MEMCFG_B23_CACHE    (FMC_PFB23CR_B1ICE_MASK | FMC_PFB23CR_B1DCE_MASK)
+#define MEMCFG_B23_PF       (FMC_PFB23CR_B1IPE_MASK | FMC_PFB23CR_B1DPE_MASK)
+#define MEMCFG_FMC_INV      (FMC_PFB01CR_CINV_WAY_MASK | FMC_PFB01CR_S_B_INV_MASK)
+#define MEMCFG_LMEM_LINE    16U
+#define MEMCFG_LCMD_INV     1U          /* Line command: invalidate */
+
+/****************************************************************************************
+* MemCfgSet() - Applies a cache and prefetch setting.
+*    Parameters: cfg is MEMCFG_xxx or'd together
+****************************************************************************************/
+void MemCfgSet(INT8U cfg){
+    INT32U b01;
+    INT32U b23;
+
+    /* LMEM: clean and invalidate, then switch */
+    if((LMEM->PCCCR & LMEM_PCCCR_ENCACHE_MASK) != 0){
+        LMEM->PCCCR |= MEMCFG_LMEM_CLEAR | LMEM_PCCCR_GO_MASK;
+        while((LMEM->PCCCR & LMEM_PCCCR_GO_MASK) != 0){
+        }
+    }else{
+    }
+    if((cfg & MEMCFG_LMEM) != 0){
+        LMEM->PCCCR = LMEM_PCCCR_INVW0_MASK | LMEM_PCCCR_INVW1_MASK | LMEM_PCCCR_GO_MASK;
+        while((LMEM->PCCCR & LMEM_PCCCR_GO_MASK) != 0){
+        }
+        LMEM->PCCCR = MEMCFG_LMEM_ON;
+    }else{
+        LMEM->PCCCR = 0;
+    }
+
+    /* FMC: wait states and the rest of the bank setup stay as they are */
+    b01 = FMC->PFB01CR & ~(MEMCFG_B01_CACHE | MEMCFG_B01_PF);
+    b23 = FMC->PFB23CR & ~(MEMCFG_B23_CACHE | MEMCFG_B23_PF);
+    if((cfg & MEMCFG_FMC) != 0){
+        b01 |= MEMCFG_B01_CACHE;
+        b23 |= MEMCFG_B23_CACHE;
+    }else{
+    }
+    if((cfg & MEMCFG_PREFETCH) != 0){
+        b01 |= MEMCFG_B01_PF;
+        b23 |= MEMCFG_B23_PF;
+    }else{
+    }
+    FMC->PFB01CR = b01 | MEMCFG_FMC_INV;
+    FMC->PFB23CR = b23;
+    __DSB();
+    __ISB();
+}
+
+/****************************************************************************************
+* MemCfgGet() - Reads the current setting back from the hardware.
+*    return: MEMCFG_xxx or'd together
+****************************************************************************************/
+INT8U MemCfgGet(void){
+    INT8U cfg = MEMCFG_NONE;
+    if((LMEM->PCCCR & LMEM_PCCCR_ENCACHE_MASK) != 0){
+        cfg |= MEMCFG_LMEM;
+    }else{
+    }
+    if((FMC->PFB01CR & MEMCFG_B01_CACHE) != 0){
+        cfg |= MEMCFG_FMC;
+    }else{
+    }
+    if((FMC->PFB01CR & MEMCFG_B01_PF) != 0){
+        cfg |= MEMCFG_PREFETCH;
+    }else{
+    }
+    return cfg;
+}
+
+/****************************************************************************************
+* MemCfgFlashInval() - Drops cached copies of flash that was just programmed or
+*                      erased. LMEM lines are invalidated one by one, so the
+*                      write-back SRAM_L lines are left alone. The FMC cache is
+*                      invalidated as a whole, it has no line commands.
+*    Parameters: addr is the first byte, bytes the length
+****************************************************************************************/
+void MemCfgFlashInval(INT32U addr, INT32U bytes){
+    INT32U line;
+    if((LMEM->PCCCR & LMEM_PCCCR_ENCACHE_MASK) != 0){
+        LMEM->PCCLCR = LMEM_PCCLCR_LADSEL_MASK | LMEM_PCCLCR_LCMD(MEMCFG_LCMD_INV);
+        for(line = addr & ~(MEMCFG_LMEM_LINE - 1U); line < (addr + bytes); line += MEMCFG_LMEM_LINE){
+            LMEM->PCCSAR = line | LMEM_PCCSAR_LGO_MASK;
+            while((LMEM->PCCSAR & LMEM_PCCSAR_LGO_MASK) != 0){
+            }
+        }
+    }else{
+    }
+    FMC->PFB01CR |= MEMCFG_FMC_INV;
+    __DSB();
+    __ISB();
+}
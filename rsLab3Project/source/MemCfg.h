@@ -0,0 +1,48 @@
+/****************************************************************************************
+* MemCfg.h - Cache and flash prefetch configuration.
+*
+*   Three independent settings, or'd together for MemCfgSet():
+*   MEMCFG_LMEM     LMEM processor code cache, 8KB in front of the code bus.
+*                   It caches flash and SRAM_L. The K65 has no system cache.
+*   MEMCFG_FMC      FMC instruction and data caches of both flash bank pairs.
+*   MEMCFG_PREFETCH FMC instruction and data speculation (prefetch) buffers.
+*
+*   Every change invalidates everything it touches, so a bench run after
+*   MemCfgSet() starts cold.
+*
+****************************************************************************************/
+#ifndef MEMCFG_INCL
+#define MEMCFG_INCL
+
+#define MEMCFG_NONE         0x00U
+#define MEMCFG_LMEM         0x01U
+#define MEMCFG_FMC          0x02U
+#define MEMCFG_PREFETCH     0x04U
+#define MEMCFG_ALL          0x07U
+#define MEMCFG_NUM          8U          /* Number of combinations */
+
+#define MEMCFG_BOOT         MEMCFG_ALL  /* Applied by main() after the clock */
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* MemCfgSet() - Applies a cache and prefetch setting.
+*    Parameters: cfg is MEMCFG_xxx or'd together
+****************************************************************************************/
+void MemCfgSet(INT8U cfg);
+
+/****************************************************************************************
+* MemCfgGet() - Reads the current setting back from the hardware.
+*    return: MEMCFG_xxx or'd together
+****************************************************************************************/
+INT8U MemCfgGet(void);
+
+/****************************************************************************************
+* MemCfgFlashInval() - Drops cached copies of flash that was just programmed or
+*                      erased.
+*    Parameters: addr is the first byte, bytes the length
+****************************************************************************************/
+void MemCfgFlashInval(INT32U addr, INT32U bytes);
+
+#endif
@@ -0,0 +1,343 @@
+/****************************************************************************************
+* Persist.c - Counter checkpoints in a program flash log.
+*
+*   A record is three phrases: magic and sequence number, the counts, and a
+*   check word over the rest. Phrases are programmed in order, so a record
+*   torn by a reset fails its check and the one before it is restored. The
+*   slot of a record follows from its sequence number, and a slot left dirty
+*   that way is skipped rather than erased, which would take the newest
+*   records in its sector with it.
+*
+*   Read-while-write works per 512KB block. The log is in the last program
+*   flash block and the image in the first, so the CPU and every interrupt
+*   keep running from flash while a command is in progress. Any read of
+*   0x00180000-0x001FFFFF collides with it though, and the boot rescan, the
+*   integrity scan and cs all read there. The main loop does not call
+*   PersistTask() while they run, and PersistWait() finishes a checkpoint
+*   before one starts. The task launches a command and comes back on a later
+*   pass to see whether it is done, so a sector erase takes no CPU time beyond
+*   the launch. The latency is from taking the counts to the last phrase
+*   programmed.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "TimeStamp.h"
+#include "Counter.h"
+#include "MemCfg.h"
+#include "ChkSum.h"
+#include "Persist.h"
+
+#define PERSIST_MAGIC       0x434E5450U     /* "CNTP" */
+#define PERSIST_PHRASE      8U              /* Program Phrase unit */
+#define PERSIST_REC_PHRASES ((INT8U)(sizeof(PERSIST_REC) / PERSIST_PHRASE))
+#define PERSIST_SECT_RECS   (PERSIST_SECT_BYTES / sizeof(PERSIST_REC))
+#define PERSIST_RECS        (PERSIST_SECT_RECS * PERSIST_SECTORS)
+#define PERSIST_ERASED      0xFFFFFFFFU
+#define PERSIST_CMD_PROG    0x07U           /* Program Phrase */
+#define PERSIST_CMD_ERASE   0x09U           /* Erase Flash Sector */
+#define PERSIST_FSTAT_CLR   (FTFE_FSTAT_ACCERR_MASK | FTFE_FSTAT_FPVIOL_MASK | \
+                             FTFE_FSTAT_RDCOLERR_MASK)
+#define PERSIST_FSTAT_ERR   (FTFE_FSTAT_ACCERR_MASK | FTFE_FSTAT_FPVIOL_MASK | \
+                             FTFE_FSTAT_MGSTAT0_MASK)
+#define PERSIST_PMSTAT_RUN  0x01U           /* Not HSRUN or VLPR */
+#define PERSIST_MS_PER_S    1000U
+
+#define PERSIST_IDLE        0U
+#define PERSIST_ERASING     1U
+#define PERSIST_PROGRAMMING 2U
+
+typedef struct{
+    INT32U magic;
+    INT32U seq;
+    INT32U cnt[CNT_NUM_STRAT];
+    INT32U check;                   /* In the last phrase */
+}PERSIST_REC;
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static PERSIST_INFO persistInfo;        /* Counts and timing, busy is not kept here */
+static PERSIST_REC persistRec;          /* Record being written */
+static INT32U persistSaved[CNT_NUM_STRAT]; /* Counts in the newest record */
+static INT32U persistAddr;              /* Flash address of persistRec */
+static INT8U persistState;
+static INT8U persistPhrase;             /* Phrase of persistRec in progress */
+static INT8U persistForce;              /* PersistSave() was called */
+static INT32U persistStart;             /* Time stamp when the counts were taken */
+static INT32U persistTs;                /* Time stamp persistAge counts from */
+static INT32U persistAge;               /* ms since the last checkpoint, up to PERSIST_MAX_MS */
+
+static void persistBegin(INT32U now);
+static void persistStep(INT32U now);
+static void persistLaunch(INT8U cmd, INT32U addr, const INT32U *data);
+static INT32U persistSlot(INT32U slot);
+static INT8U persistBlank(INT32U addr, INT32U bytes);
+static INT32U persistCheck(const PERSIST_REC *rec);
+
+/****************************************************************************************
+* PersistInit() - Finds the newest valid record and restores the counts from it.
+*                 Needs TSInit() and CntInit(), and must come before anything
+*                 that takes a count as its starting point. If the image reaches
+*                 PERSIST_BASE the log is left alone and info.off is set.
+****************************************************************************************/
+void PersistInit(void){
+    INT32U start = TS_GET();
+    const PERSIST_REC *rec;
+    const PERSIST_REC *best = 0;
+    INT32U slot;
+    INT32U low;
+    INT32U high;
+    INT8U strat;
+
+    SIM->SCGC6 |= SIM_SCGC6_FTF_MASK;
+    CsImageRange(&low, &high);
+    persistInfo.off = (INT8U)(high >= PERSIST_BASE);
+    for(slot = 0; (slot < PERSIST_RECS) && (persistInfo.off == FALSE); slot++){
+        rec = (const PERSIST_REC *)persistSlot(slot);
+        if((rec->magic == PERSIST_MAGIC) && (rec->check == persistCheck(rec)) &&
+           ((best == 0) || (rec->seq > best->seq))){
+            best = rec;
+        }else{
+        }
+    }
+    if(best != 0){
+        CntRestore(best->cnt);
+        for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+            persistSaved[strat] = best->cnt[strat];
+        }
+        persistInfo.seq = best->seq;
+        persistInfo.restored = TRUE;
+    }else{
+        for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+            persistSaved[strat] = 0;
+        }
+        persistInfo.seq = PERSIST_ERASED;   /* The first record is 0, in slot 0 */
+        persistInfo.restored = FALSE;
+    }
+    persistInfo.next = persistSlot((persistInfo.seq + 1U) % PERSIST_RECS);
+    persistState = PERSIST_IDLE;
+    persistForce = FALSE;
+    persistAge = 0;
+    persistTs = TS_GET();
+    persistInfo.boot_cyc = persistTs - start;
+}
+
+/****************************************************************************************
+* PersistTask() - Starts a checkpoint when one is due and moves a running one on
+*                 by one flash command. Never waits on the flash. Call once per
+*                 main loop pass.
+****************************************************************************************/
+void PersistTask(void){
+    INT32U now = TS_GET();
+    INT32U cyc_ms = SystemCoreClock / PERSIST_MS_PER_S;
+    INT32U ms = (now - persistTs) / cyc_ms;
+    INT32U diff;
+    INT8U due;
+    INT8U strat;
+
+    if(ms != 0){
+        persistTs += ms * cyc_ms;
+        persistAge = ((persistAge + ms) < PERSIST_MAX_MS) ? (persistAge + ms) : PERSIST_MAX_MS;
+    }else{
+    }
+    switch(persistState){
+    case(PERSIST_IDLE):
+        due = persistForce;
+        for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+            diff = CntGet(strat) - persistSaved[strat];
+            if((diff != 0) && (((diff >= PERSIST_DELTA) && (persistAge >= PERSIST_MIN_MS)) ||
+                               (persistAge >= PERSIST_MAX_MS))){
+                due = TRUE;
+            }else{
+            }
+        }
+        if((due == FALSE) || (persistInfo.off != FALSE)){
+        }else if(SMC->PMSTAT == PERSIST_PMSTAT_RUN){
+            persistInfo.held = FALSE;
+            persistBegin(now);
+        }else{
+            persistInfo.held = TRUE;
+        }
+        break;
+    default:
+        if((FTFE->FSTAT & FTFE_FSTAT_CCIF_MASK) != 0){
+            persistStep(now);
+        }else{
+        }
+        break;
+    }
+}
+
+/****************************************************************************************
+* PersistSave() - Makes a checkpoint due now, changed counts or not.
+****************************************************************************************/
+void PersistSave(void){
+    persistForce = TRUE;
+}
+
+/****************************************************************************************
+* PersistWait() - Runs a checkpoint in progress to the end, every flash command
+*                 of it. Call before the clock profile changes or anything reads
+*                 the last program flash block.
+****************************************************************************************/
+void PersistWait(void){
+    while(persistState != PERSIST_IDLE){
+        if((FTFE->FSTAT & FTFE_FSTAT_CCIF_MASK) != 0){
+            persistStep(TS_GET());
+        }else{
+        }
+    }
+}
+
+/****************************************************************************************
+* PersistInfo() - Checkpoint counts and timing.
+****************************************************************************************/
+void PersistInfo(PERSIST_INFO *info){
+    *info = persistInfo;
+    info->busy = (INT8U)(persistState != PERSIST_IDLE);
+}
+
+/****************************************************************************************
+* persistBegin() - Takes the counts and launches the first command of a
+*                  checkpoint: an erase when the record opens a sector that is
+*                  not blank, its first phrase otherwise.
+****************************************************************************************/
+static void persistBegin(INT32U now){
+    INT32U seq = persistInfo.seq + 1U;
+    INT32U slot = seq % PERSIST_RECS;
+    INT8U strat;
+
+    while(((slot % PERSIST_SECT_RECS) != 0) &&
+          (persistBlank(persistSlot(slot), sizeof(PERSIST_REC)) == FALSE)){
+        seq++;
+        slot = seq % PERSIST_RECS;
+    }
+    persistRec.magic = PERSIST_MAGIC;
+    persistRec.seq = seq;
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        persistRec.cnt[strat] = CntGet(strat);
+    }
+    persistRec.check = persistCheck(&persistRec);
+    persistAddr = persistSlot(slot);
+    persistPhrase = 0;
+    persistForce = FALSE;
+    persistStart = now;
+    if(((slot % PERSIST_SECT_RECS) == 0) &&
+       (persistBlank(persistAddr, PERSIST_SECT_BYTES) == FALSE)){
+        persistState = PERSIST_ERASING;
+        persistLaunch(PERSIST_CMD_ERASE, persistAddr, 0);
+    }else{
+        persistState = PERSIST_PROGRAMMING;
+        persistLaunch(PERSIST_CMD_PROG, persistAddr, (const INT32U *)&persistRec);
+    }
+}
+
+/****************************************************************************************
+* persistStep() - Follows up a finished command with the next one, or closes
+*                 the checkpoint. A failed command drops the checkpoint, and the
+*                 retry waits as long as it would after a good one.
+****************************************************************************************/
+static void persistStep(INT32U now){
+    const INT32U *words = (const INT32U *)&persistRec;
+    INT32U lat;
+    INT8U strat;
+
+    if((FTFE->FSTAT & PERSIST_FSTAT_ERR) != 0){
+        MemCfgFlashInval(persistAddr, (persistState == PERSIST_ERASING) ?
+                                      PERSIST_SECT_BYTES : sizeof(PERSIST_REC));
+        persistInfo.errors++;
+        persistState = PERSIST_IDLE;
+        persistAge = 0;
+    }else if(persistState == PERSIST_ERASING){
+        MemCfgFlashInval(persistAddr, PERSIST_SECT_BYTES);
+        persistInfo.erases++;
+        persistState = PERSIST_PROGRAMMING;
+        persistLaunch(PERSIST_CMD_PROG, persistAddr, words);
+    }else{
+        persistPhrase++;
+        if(persistPhrase < PERSIST_REC_PHRASES){
+            persistLaunch(PERSIST_CMD_PROG, persistAddr + (persistPhrase * PERSIST_PHRASE),
+                          &words[persistPhrase * (PERSIST_PHRASE / 4U)]);
+        }else{
+            MemCfgFlashInval(persistAddr, sizeof(PERSIST_REC));
+            for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+                persistSaved[strat] = persistRec.cnt[strat];
+            }
+            persistInfo.seq = persistRec.seq;
+            persistInfo.next = persistSlot((persistRec.seq + 1U) % PERSIST_RECS);
+            persistInfo.saves++;
+            lat = now - persistStart;
+            persistInfo.last_cyc = lat;
+            if(lat > persistInfo.max_cyc){
+                persistInfo.max_cyc = lat;
+            }else{
+            }
+            persistState = PERSIST_IDLE;
+            persistAge = 0;
+            persistTs = now;
+        }
+    }
+}
+
+/****************************************************************************************
+* persistLaunch() - Loads FCCOB and starts a flash command.
+*    Parameters: data is the phrase for PERSIST_CMD_PROG, 0 for an erase
+****************************************************************************************/
+static void persistLaunch(INT8U cmd, INT32U addr, const INT32U *data){
+    FTFE->FSTAT = PERSIST_FSTAT_CLR;
+    FTFE->FCCOB0 = cmd;
+    FTFE->FCCOB1 = (INT8U)(addr >> 16);
+    FTFE->FCCOB2 = (INT8U)(addr >> 8);
+    FTFE->FCCOB3 = (INT8U)addr;
+    if(data != 0){
+        /* FCCOB7 and FCCOBB take the lowest addressed byte of each word */
+        FTFE->FCCOB4 = (INT8U)(data[0] >> 24);
+        FTFE->FCCOB5 = (INT8U)(data[0] >> 16);
+        FTFE->FCCOB6 = (INT8U)(data[0] >> 8);
+        FTFE->FCCOB7 = (INT8U)data[0];
+        FTFE->FCCOB8 = (INT8U)(data[1] >> 24);
+        FTFE->FCCOB9 = (INT8U)(data[1] >> 16);
+        FTFE->FCCOBA = (INT8U)(data[1] >> 8);
+        FTFE->FCCOBB = (INT8U)data[1];
+    }else{
+    }
+    FTFE->FSTAT = FTFE_FSTAT_CCIF_MASK;
+}
+
+/****************************************************************************************
+* persistSlot() - Flash address of a record slot. Records do not straddle
+*                 sectors, so each sector has a few unused bytes at its end.
+****************************************************************************************/
+static INT32U persistSlot(INT32U slot){
+    return PERSIST_BASE + ((slot / PERSIST_SECT_RECS) * PERSIST_SECT_BYTES) +
+           ((slot % PERSIST_SECT_RECS) * sizeof(PERSIST_REC));
+}
+
+/****************************************************************************************
+* persistBlank() - TRUE if every word of a flash block reads erased.
+****************************************************************************************/
+static INT8U persistBlank(INT32U addr, INT32U bytes){
+    const INT32U *word = (const INT32U *)addr;
+    INT32U i;
+    INT8U blank = TRUE;
+    for(i = 0; (i < (bytes / 4U)) && (blank != FALSE); i++){
+        if(word[i] != PERSIST_ERASED){
+            blank = FALSE;
+        }else{
+        }
+    }
+    return blank;
+}
+
+/****************************************************************************************
+* persistCheck() - Check word of a record, the complement of the sum of the
+*                  words before it.
+****************************************************************************************/
+static INT32U persistCheck(const PERSIST_REC *rec){
+    INT32U sum = rec->magic + rec->seq;
+    INT8U strat;
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        sum += rec->cnt[strat];
+    }
+    return ~sum;
+}
@@ -0,0 +1,79 @@
+/****************************************************************************************
+* Persist.h - Counter checkpoints in a program flash log.
+*
+*   The FN part on the K65TWR has no FlexNVM, so there is no EEPROM emulation
+*   in FlexRAM. The counts are instead appended as small records to a ring of
+*   PERSIST_SECTORS sectors at the top of program flash. Records are only ever
+*   appended to erased phrases, and a sector is erased when the ring comes
+*   back to it, so every sector sees the same number of erases.
+*
+*   A checkpoint is taken once a count moved by PERSIST_DELTA and
+*   PERSIST_MIN_MS passed since the last one, or PERSIST_MAX_MS after any
+*   change at all. At most PERSIST_MAX_MS of counting is lost to a reset.
+*
+*   Flash cannot be programmed in HSRUN. The board boots at 120MHz in RUN for
+*   that, and checkpoints are held while the clock is switched to 180MHz.
+*
+*   The log is not used at all if the image reaches into it.
+*
+****************************************************************************************/
+#ifndef PERSIST_INCL
+#define PERSIST_INCL
+
+#define PERSIST_BASE        0x001FC000U     /* Log sectors, kept out of the boot checksum */
+#define PERSIST_SECTORS     4U
+#define PERSIST_SECT_BYTES  4096U
+#define PERSIST_DELTA       100U            /* Counts that make a checkpoint due */
+#define PERSIST_MIN_MS      1000U           /* Shortest time between checkpoints */
+#define PERSIST_MAX_MS      10000U          /* Longest time a change goes unsaved */
+
+typedef struct{
+    INT32U saves;                   /* Checkpoints written since boot */
+    INT32U erases;                  /* Sectors erased since boot */
+    INT32U errors;                  /* Flash commands that failed */
+    INT32U seq;                     /* Sequence number of the newest record */
+    INT32U next;                    /* Flash address of the next record */
+    INT32U last_cyc;                /* Latency of the last checkpoint */
+    INT32U max_cyc;                 /* and the longest since boot */
+    INT32U boot_cyc;                /* Time PersistInit() took */
+    INT8U restored;                 /* The counts came from the log */
+    INT8U off;                      /* The image reaches PERSIST_BASE, no log */
+    INT8U held;                     /* A checkpoint is due but the core is in HSRUN */
+    INT8U busy;                     /* A checkpoint is being written */
+}PERSIST_INFO;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* PersistInit() - Finds the newest valid record and restores the counts from it.
+*                 Needs TSInit() and CntInit(), and must come before anything
+*                 that takes a count as its starting point.
+****************************************************************************************/
+void PersistInit(void);
+
+/****************************************************************************************
+* PersistTask() - Starts a checkpoint when one is due and moves a running one on
+*                 by one flash command. Never waits on the flash. Call once per
+*                 main loop pass.
+****************************************************************************************/
+void PersistTask(void);
+
+/****************************************************************************************
+* PersistSave() - Makes a checkpoint due now, changed counts or not.
+****************************************************************************************/
+void PersistSave(void);
+
+/****************************************************************************************
+* PersistWait() - Runs a checkpoint in progress to the end, every flash command
+*                 of it. Call before the clock profile changes or anything reads
+*                 the last program flash block.
+****************************************************************************************/
+void PersistWait(void);
+
+/****************************************************************************************
+* PersistInfo() - Checkpoint counts and timing.
+****************************************************************************************/
+void PersistInfo(PERSIST_INFO *info);
+
+#endif
@@ -0,0 +1,155 @@
+/****************************************************************************************
+* PressStat.c - SW2 hold time and press interval statistics.
+*
+*   Press and release times are put on the history clock, microseconds in 64
+*   bits, as soon as their DWT stamps show up, while those are still recent.
+*   Long holds and gaps then do not wrap, and StatCalc() only has to run the
+*   statistics. The windows are rings, which the
+*   statistics do not care about, so they are passed from index 0 as they are.
+*   The standard deviation is the sample one (n - 1), as arm_std_f32() does.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "TimeStamp.h"
+#include "Counter.h"
+#include "History.h"
+#include "PressStat.h"
+#if !APP_TYPE_CMSIS_EN
+#include <math.h>
+#endif
+
+#define STAT_US_PER_S       1000000U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static FP32 statWin[STAT_NUM_SER][STAT_WIN];
+static INT8U statN[STAT_NUM_SER];       /* Samples in each window */
+static INT8U statNext[STAT_NUM_SER];    /* Next slot to write */
+static INT32U statSeen;                 /* CntPresses() already taken */
+static INT32U statDownTs;               /* CntLastPress() press stamp already taken */
+static INT64U statDownUs;               /* and its time on the history clock */
+static INT64U statLastDownUs;           /* Press time of the previous press */
+static INT8U statHaveDown;              /* statLastDownUs is valid */
+
+static void statAdd(INT8U ser, INT64U us);
+
+/****************************************************************************************
+* StatTask() - Picks up a new press from the counter module. Call once per
+*              main loop pass. Needs HistInit().
+****************************************************************************************/
+void StatTask(void){
+    INT32U presses = CntPresses();
+    INT32U now = TS_GET();
+    INT64U now_us = HistNowUs();
+    INT32U cyc_us = SystemCoreClock / STAT_US_PER_S;
+    INT32U down;
+    INT32U up;
+
+    CntLastPress(&down, &up);
+    if(down != statDownTs){
+        /* A press started, its stamp is at most a pass old */
+        statDownTs = down;
+        statDownUs = now_us - ((now - down) / cyc_us);
+    }else{
+    }
+    if(presses != statSeen){
+        /* Presses are at least two debounce times apart, none is missed */
+        statSeen = presses;
+        statAdd(STAT_HOLD, (now_us - ((now - up) / cyc_us)) - statDownUs);
+        if(statHaveDown != FALSE){
+            statAdd(STAT_GAP, statDownUs - statLastDownUs);
+        }else{
+        }
+        statLastDownUs = statDownUs;
+        statHaveDown = TRUE;
+    }else{
+    }
+}
+
+/****************************************************************************************
+* StatCalc() - Statistics of one window.
+*    Parameters: ser is STAT_HOLD or STAT_GAP
+*                *res is filled in, all zero for an empty window
+****************************************************************************************/
+void StatCalc(INT8U ser, STAT_RESULT *res){
+    FP32 *win = statWin[ser];
+    INT8U n = statN[ser];
+#if APP_TYPE_CMSIS_EN
+    uint32_t idx;
+#else
+    INT8U i;
+    FP32 sum = 0.0f;
+    FP32 sumsq = 0.0f;
+    FP32 dev;
+#endif
+
+    res->n = n;
+    res->mean = 0.0f;
+    res->std = 0.0f;
+    res->min = 0.0f;
+    res->max = 0.0f;
+    res->rms = 0.0f;
+    if(n > 0){
+#if APP_TYPE_CMSIS_EN
+        arm_mean_f32(win, n, &res->mean);
+        arm_rms_f32(win, n, &res->rms);
+        arm_min_f32(win, n, &res->min, &idx);
+        arm_max_f32(win, n, &res->max, &idx);
+        if(n > 1U){
+            arm_std_f32(win, n, &res->std);
+        }else{
+        }
+#else
+        res->min = win[0];
+        res->max = win[0];
+        for(i = 0; i < n; i++){
+            sum += win[i];
+            sumsq += win[i] * win[i];
+            if(win[i] < res->min){
+                res->min = win[i];
+            }else{
+            }
+            if(win[i] > res->max){
+                res->max = win[i];
+            }else{
+            }
+        }
+        res->mean = sum / (FP32)n;
+        res->rms = sqrtf(sumsq / (FP32)n);
+        if(n > 1U){
+            dev = 0.0f;
+            for(i = 0; i < n; i++){
+                dev += (win[i] - res->mean) * (win[i] - res->mean);
+            }
+            res->std = sqrtf(dev / (FP32)(n - 1U));
+        }else{
+        }
+#endif
+    }else{
+    }
+}
+
+/****************************************************************************************
+* StatClear() - Empties both windows.
+****************************************************************************************/
+void StatClear(void){
+    INT8U ser;
+    for(ser = 0; ser < STAT_NUM_SER; ser++){
+        statN[ser] = 0;
+        statNext[ser] = 0;
+    }
+    statHaveDown = FALSE;
+}
+
+/****************************************************************************************
+* statAdd() - Adds a sample in microseconds to a window. Private.
+****************************************************************************************/
+static void statAdd(INT8U ser, INT64U us){
+    statWin[ser][statNext[ser]] = (FP32)us;
+    statNext[ser] = (INT8U)((statNext[ser] + 1U) % STAT_WIN);
+    if(statN[ser] < STAT_WIN){
+        statN[ser]++;
+    }else{
+    }
+}
@@ -0,0 +1,50 @@
+/****************************************************************************************
+* PressStat.h - SW2 hold time and press interval statistics.
+*
+*   Each debounced press adds a hold time (press to release) and an interval
+*   (press to previous press) to windows of the last STAT_WIN samples.
+*   StatCalc() works on a window with the CMSIS-DSP f32 statistics functions
+*   when APP_TYPE_CMSIS_EN is set, plain loops otherwise. Times are taken on
+*   the history clock, so long holds and intervals do not wrap.
+*
+****************************************************************************************/
+#ifndef STAT_INCL
+#define STAT_INCL
+
+#define STAT_WIN            32U     /* Samples per window */
+
+#define STAT_HOLD           0U      /* Press to release */
+#define STAT_GAP            1U      /* Press to next press */
+#define STAT_NUM_SER        2U
+
+typedef struct{
+    INT8U n;                        /* Samples in the window */
+    FP32 mean;                      /* All in microseconds */
+    FP32 std;                       /* 0 with fewer than two samples */
+    FP32 min;
+    FP32 max;
+    FP32 rms;
+}STAT_RESULT;
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* StatTask() - Picks up a new press from the counter module. Call once per
+*              main loop pass. Needs HistInit().
+****************************************************************************************/
+void StatTask(void);
+
+/****************************************************************************************
+* StatCalc() - Statistics of one window.
+*    Parameters: ser is STAT_HOLD or STAT_GAP
+*                *res is filled in, all zero for an empty window
+****************************************************************************************/
+void StatCalc(INT8U ser, STAT_RESULT *res);
+
+/****************************************************************************************
+* StatClear() - Empties both windows.
+****************************************************************************************/
+void StatClear(void);
+
+#endif
@@ -0,0 +1,186 @@
+/****************************************************************************************
+* Quant.c - Streaming quantiles of SW2 edge timing.
+*
+*   Bucket index of a value v with its top bit at position e (e >= SUB_BITS):
+*   (e - SUB_BITS + 1) * SUB plus the SUB_BITS bits below the top bit. That
+*   is one CLZ and a shift per sample. tools/quantchk.c carries the same code
+*   and checks it against sorted samples.
+*
+*   Stamps only come in while the CNT_ISR_STAMP handler is installed. When
+*   the ring wraps between two passes, the interval into the oldest stamp
+*   that is left is unknown, so the chain starts over there.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "Counter.h"
+#include "Quant.h"
+
+#define QUANT_Q_FULL        10000U  /* QuantGet() q for the whole sketch */
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static INT32U quantHist[QUANT_NUM][QUANT_BUCKETS];
+static INT32U quantN[QUANT_NUM];
+static INT32U quantNext;                /* Next time stamp wanted */
+static INT32U quantPrev;                /* Last time stamp taken */
+static INT8U quantHavePrev;             /* quantPrev is valid */
+static INT32U quantLost;
+
+static INT16U quantIdx(INT32U val);
+static INT32U quantMid(INT16U idx);
+
+/****************************************************************************************
+* QuantTask() - Adds the intervals between new SW2 time stamps to QUANT_EDGE.
+*               Call once per main loop pass.
+****************************************************************************************/
+void QuantTask(void){
+    INT32U stamps[CNT_STAMPS];
+    INT32U from = quantNext;
+    INT8U n;
+    INT8U i;
+    n = CntStampsNew(&quantNext, stamps);
+    if((quantNext - from) != n){
+        quantLost += (quantNext - from) - n;
+        quantHavePrev = FALSE;
+    }else{
+    }
+    for(i = 0; i < n; i++){
+        if(quantHavePrev != FALSE){
+            QuantAdd(QUANT_EDGE, stamps[i] - quantPrev);
+        }else{
+        }
+        quantPrev = stamps[i];
+        quantHavePrev = TRUE;
+    }
+}
+
+/****************************************************************************************
+* QuantLatency() - Adds QUANT_LAT_RUNS edge latencies to QUANT_LAT. Blocks for
+*                  about 0.1s. SW2 must not be pressed.
+*    return: edges that timed out and were not added
+****************************************************************************************/
+INT32U QuantLatency(void){
+    INT32U i;
+    INT32U lat;
+    INT32U missed = 0;
+    for(i = 0; i < QUANT_LAT_RUNS; i++){
+        lat = CntEdgeLatency();
+        if(lat != 0){
+            QuantAdd(QUANT_LAT, lat);
+        }else{
+            missed++;
+        }
+    }
+    return missed;
+}
+
+/****************************************************************************************
+* QuantAdd() - Adds one sample to a sketch.
+****************************************************************************************/
+void QuantAdd(INT8U sk, INT32U val){
+    quantHist[sk][quantIdx(val)]++;
+    quantN[sk]++;
+}
+
+/****************************************************************************************
+* QuantGet() - Estimates a quantile.
+*    Parameters: sk is QUANT_EDGE or QUANT_LAT
+*                q is the quantile in parts per 10000, 9990 for p99.9
+*    return: the estimate in core cycles, 0 for an empty sketch
+****************************************************************************************/
+INT32U QuantGet(INT8U sk, INT16U q){
+    INT32U rank;
+    INT32U cum = 0;
+    INT16U idx = 0;
+    INT32U est = 0;
+    if(quantN[sk] != 0){
+        /* Nearest rank, 1 based: the smallest sample with at least q of
+         * them at or below it */
+        rank = (INT32U)((((INT64U)quantN[sk] * q) + (QUANT_Q_FULL - 1U)) / QUANT_Q_FULL);
+        if(rank == 0){
+            rank = 1;
+        }else{
+        }
+        cum = quantHist[sk][0];
+        while(cum < rank){
+            idx++;
+            cum += quantHist[sk][idx];
+        }
+        est = quantMid(idx);
+    }else{
+    }
+    return est;
+}
+
+/****************************************************************************************
+* QuantCount() - Samples in a sketch.
+****************************************************************************************/
+INT32U QuantCount(INT8U sk){
+    return quantN[sk];
+}
+
+/****************************************************************************************
+* QuantLost() - SW2 edges whose interval was not seen because the time stamp
+*               ring had wrapped before QuantTask() got to it.
+****************************************************************************************/
+INT32U QuantLost(void){
+    return quantLost;
+}
+
+/****************************************************************************************
+* QuantRestart() - Forgets the last SW2 time stamp, so no interval is taken
+*                  across a gap in the stamps such as an isr mode change.
+****************************************************************************************/
+void QuantRestart(void){
+    quantHavePrev = FALSE;
+}
+
+/****************************************************************************************
+* QuantClear() - Empties both sketches.
+****************************************************************************************/
+void QuantClear(void){
+    INT8U sk;
+    INT16U i;
+    for(sk = 0; sk < QUANT_NUM; sk++){
+        for(i = 0; i < QUANT_BUCKETS; i++){
+            quantHist[sk][i] = 0;
+        }
+        quantN[sk] = 0;
+    }
+    quantLost = 0;
+    QuantRestart();
+}
+
+/****************************************************************************************
+* quantIdx() - Bucket of a value.
+****************************************************************************************/
+static INT16U quantIdx(INT32U val){
+    INT32U e;
+    INT16U idx;
+    if(val < QUANT_SUB){
+        idx = (INT16U)val;
+    }else{
+        e = 31U - __CLZ(val);
+        idx = (INT16U)(((e - QUANT_SUB_BITS + 1U) * QUANT_SUB) +
+                       ((val >> (e - QUANT_SUB_BITS)) & (QUANT_SUB - 1U)));
+    }
+    return idx;
+}
+
+/****************************************************************************************
+* quantMid() - Middle of a bucket, the value returned for every sample in it.
+****************************************************************************************/
+static INT32U quantMid(INT16U idx){
+    INT32U e;
+    INT32U low;
+    INT32U mid;
+    if(idx < QUANT_SUB){
+        mid = idx;
+    }else{
+        e = (idx / QUANT_SUB) + QUANT_SUB_BITS - 1U;
+        low = (1UL << e) + ((INT32U)(idx & (QUANT_SUB - 1U)) << (e - QUANT_SUB_BITS));
+        mid = low + ((1UL << (e - QUANT_SUB_BITS)) >> 1);
+    }
+    return mid;
+}
@@ -0,0 +1,77 @@
+/****************************************************************************************
+* Quant.h - Streaming quantiles of SW2 edge timing.
+*
+*   Each sketch is a log histogram: values below 2^QUANT_SUB_BITS have a bucket
+*   each, larger ones fall in one of 2^QUANT_SUB_BITS buckets per power of two.
+*   Counts are exact, so a quantile always comes from the bucket holding the
+*   sample of that rank, and the bucket's midpoint is within 1/2^(SUB_BITS+1)
+*   (3.1%) of it. Memory is fixed whatever the number of samples.
+*
+*   QUANT_EDGE is fed the time between SW2 edges from the CNT_ISR_STAMP time
+*   stamps. QUANT_LAT is fed by QuantLatency() with edges driven from GPIO.
+*
+****************************************************************************************/
+#ifndef QUANT_INCL
+#define QUANT_INCL
+
+#define QUANT_EDGE          0U      /* Time between SW2 edges */
+#define QUANT_LAT           1U      /* Edge to SW2 handler */
+#define QUANT_NUM           2U
+
+#define QUANT_SUB_BITS      4U
+#define QUANT_SUB           (1U << QUANT_SUB_BITS)
+#define QUANT_BUCKETS       ((32U - QUANT_SUB_BITS + 1U) * QUANT_SUB)
+#define QUANT_LAT_RUNS      1000U   /* Edges per QuantLatency() */
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* QuantTask() - Adds the intervals between new SW2 time stamps to QUANT_EDGE.
+*               Call once per main loop pass.
+****************************************************************************************/
+void QuantTask(void);
+
+/****************************************************************************************
+* QuantLatency() - Adds QUANT_LAT_RUNS edge latencies to QUANT_LAT. Blocks for
+*                  about 0.1s. SW2 must not be pressed.
+*    return: edges that timed out and were not added
+****************************************************************************************/
+INT32U QuantLatency(void);
+
+/****************************************************************************************
+* QuantAdd() - Adds one sample to a sketch.
+****************************************************************************************/
+void QuantAdd(INT8U sk, INT32U val);
+
+/****************************************************************************************
+* QuantGet() - Estimates a quantile.
+*    Parameters: sk is QUANT_EDGE or QUANT_LAT
+*                q is the quantile in parts per 10000, 9990 for p99.9
+*    return: the estimate in core cycles, 0 for an empty sketch
+****************************************************************************************/
+INT32U QuantGet(INT8U sk, INT16U q);
+
+/****************************************************************************************
+* QuantCount() - Samples in a sketch.
+****************************************************************************************/
+INT32U QuantCount(INT8U sk);
+
+/****************************************************************************************
+* QuantLost() - SW2 edges whose interval was not seen because the time stamp
+*               ring had wrapped before QuantTask() got to it.
+****************************************************************************************/
+INT32U QuantLost(void);
+
+/****************************************************************************************
+* QuantRestart() - Forgets the last SW2 time stamp, so no interval is taken
+*                  across a gap in the stamps such as an isr mode change.
+****************************************************************************************/
+void QuantRestart(void);
+
+/****************************************************************************************
+* QuantClear() - Empties both sketches.
+****************************************************************************************/
+void QuantClear(void);
+
+#endif
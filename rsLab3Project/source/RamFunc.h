@@ -0,0 +1,30 @@
+/****************************************************************************************
+* RamFunc.h - Placement of code in SRAM_L.
+*
+*   SRAM_L sits on the code bus and has no wait states, where flash needs them
+*   above the FEI clock. A function marked RAMFUNC is linked into the
+*   .ramfunc.$SRAM_LOWER section. The managed linker script collects these
+*   into the SRAM_L data section, whose flash image data_init() copies at
+*   startup along with every other data section in the global section table.
+*   Calls between flash and SRAM_L are out of BL range and go through linker
+*   veneers.
+*
+*   RAMFUNC_EN FALSE links the RAMFUNC functions in flash instead, to compare
+*   the two builds. RAMFUNC_ALWAYS is for code that must be in SRAM_L in
+*   either build.
+*
+****************************************************************************************/
+#ifndef RAMFUNC_INCL
+#define RAMFUNC_INCL
+
+#define RAMFUNC_EN          TRUE
+
+#define RAMFUNC_ALWAYS      __attribute__ ((section(".ramfunc.$SRAM_LOWER"), noinline))
+
+#if RAMFUNC_EN
+#define RAMFUNC             RAMFUNC_ALWAYS
+#else
+#define RAMFUNC
+#endif
+
+#endif
@@ -0,0 +1,144 @@
+/****************************************************************************************
+* Rate.c - Event rate of each counter strategy.
+*
+*   The counts come from CntGet(), so every SW2 handler and the moderation
+*   path are covered and the ISRs are not touched. Each pass adds one
+*   difference per strategy to the open bucket and each closed bucket costs
+*   one subtract and one add on the window sum, so nothing ever walks the
+*   ring. After a long main loop stall (selftest, csbench) the missed buckets
+*   are closed empty, up to a full window, and everything counted during the
+*   stall lands in the first one.
+*
+*   The EWMA is held in events per second with RATE_Q fraction bits and moves
+*   1/2^RATE_EWMA_SHIFT of the way to each closed bucket's rate. With Q8 it
+*   holds up to 8M events per second.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "TimeStamp.h"
+#include "Counter.h"
+#include "Rate.h"
+
+#define RATE_PER_S          (1000U / RATE_BUCKET_MS)    /* Buckets per second */
+#define RATE_Q              8U      /* EWMA fraction bits */
+#define RATE_EWMA_SHIFT     3U      /* Weight of a new bucket is 1/8 */
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static INT32U rateRing[CNT_NUM_STRAT][RATE_BUCKETS];    /* Closed bucket counts */
+static INT32U rateSum[CNT_NUM_STRAT];   /* Sum of the ring */
+static INT32U rateOpen[CNT_NUM_STRAT];  /* Count in the open bucket */
+static INT32U rateLast[CNT_NUM_STRAT];  /* CntGet() at the last pass */
+static INT32S rateEwma[CNT_NUM_STRAT];  /* Events per second, Q8 */
+static INT8U rateIdx;                   /* Ring slot the open bucket goes to */
+static INT8U rateFilled;                /* Closed buckets in the ring */
+static INT32U rateStart;                /* Time stamp the open bucket started */
+
+static void rateClose(void);
+
+/****************************************************************************************
+* RateInit() - Empties all windows and starts the first bucket. Needs TSInit()
+*              and CntInit().
+****************************************************************************************/
+void RateInit(void){
+    INT8U strat;
+    INT8U i;
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        for(i = 0; i < RATE_BUCKETS; i++){
+            rateRing[strat][i] = 0;
+        }
+        rateSum[strat] = 0;
+        rateOpen[strat] = 0;
+        rateEwma[strat] = 0;
+        rateLast[strat] = CntGet(strat);
+    }
+    rateIdx = 0;
+    rateFilled = 0;
+    rateStart = TS_GET();
+}
+
+/****************************************************************************************
+* RateTask() - Adds new counts to the open bucket and closes it when its time
+*              is up. Call once per main loop pass.
+****************************************************************************************/
+void RateTask(void){
+    INT32U bucket = SystemCoreClock / RATE_PER_S;
+    INT32U now = TS_GET();
+    INT32U cnt;
+    INT8U strat;
+    INT8U closed = 0;
+
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        cnt = CntGet(strat);
+        rateOpen[strat] += cnt - rateLast[strat];
+        rateLast[strat] = cnt;
+    }
+    while(((now - rateStart) >= bucket) && (closed < RATE_BUCKETS)){
+        rateClose();
+        rateStart += bucket;
+        closed++;
+    }
+    if(closed >= RATE_BUCKETS){
+        /* Stalled for a whole window or more, start over from now */
+        rateStart = now;
+    }else{
+    }
+}
+
+/****************************************************************************************
+* RateWindow() - Events per second over the sliding window. The window is
+*                shorter than RATE_WIN_S until that much time has passed.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: tenths of an event per second
+****************************************************************************************/
+INT32U RateWindow(INT8U strat){
+    INT32U rate = 0;
+    if((strat < CNT_NUM_STRAT) && (rateFilled > 0)){
+        rate = (INT32U)(((INT64U)rateSum[strat] * RATE_PER_S * 10U) / rateFilled);
+    }else{
+    }
+    return rate;
+}
+
+/****************************************************************************************
+* RateEwma() - Moving average of the events per second of each bucket.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: tenths of an event per second
+****************************************************************************************/
+INT32U RateEwma(INT8U strat){
+    INT32U rate = 0;
+    if((strat < CNT_NUM_STRAT) && (rateEwma[strat] > 0)){
+        rate = (INT32U)(((INT64U)rateEwma[strat] * 10U) >> RATE_Q);
+    }else{
+    }
+    return rate;
+}
+
+/****************************************************************************************
+* rateClose() - Moves the open buckets into the rings and updates the window
+*               sums and averages.
+****************************************************************************************/
+static void rateClose(void){
+    INT8U strat;
+    INT32U open;
+    INT32S inst;
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        open = rateOpen[strat];
+        rateSum[strat] += open - rateRing[strat][rateIdx];
+        rateRing[strat][rateIdx] = open;
+        rateOpen[strat] = 0;
+        /* Arithmetic shift, so a falling rate still reaches 0 */
+        inst = (INT32S)((open * RATE_PER_S) << RATE_Q);
+        rateEwma[strat] += (inst - rateEwma[strat]) >> RATE_EWMA_SHIFT;
+    }
+    rateIdx++;
+    if(rateIdx >= RATE_BUCKETS){
+        rateIdx = 0;
+    }else{
+    }
+    if(rateFilled < RATE_BUCKETS){
+        rateFilled++;
+    }else{
+    }
+}
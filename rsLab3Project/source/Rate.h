@@ -0,0 +1,48 @@
+/****************************************************************************************
+* Rate.h - Event rate of each counter strategy.
+*
+*   Time is cut into RATE_BUCKET_MS buckets. Each strategy keeps the counts of
+*   the last RATE_BUCKETS buckets in a ring and their running sum, which gives
+*   an exact events per second figure over the last RATE_WIN_S seconds, and an
+*   exponentially weighted moving average in fixed point that follows changes
+*   within about a second. Rates are returned in tenths of an event per second.
+*
+****************************************************************************************/
+#ifndef RATE_INCL
+#define RATE_INCL
+
+#define RATE_BUCKET_MS      100U    /* Bucket length */
+#define RATE_WIN_S          5U      /* Sliding window length */
+#define RATE_BUCKETS        ((RATE_WIN_S * 1000U) / RATE_BUCKET_MS)
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* RateInit() - Empties all windows and starts the first bucket. Needs TSInit()
+*              and CntInit().
+****************************************************************************************/
+void RateInit(void);
+
+/****************************************************************************************
+* RateTask() - Adds new counts to the open bucket and closes it when its time
+*              is up. Call once per main loop pass.
+****************************************************************************************/
+void RateTask(void);
+
+/****************************************************************************************
+* RateWindow() - Events per second over the sliding window. The window is
+*                shorter than RATE_WIN_S until that much time has passed.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: tenths of an event per second
+****************************************************************************************/
+INT32U RateWindow(INT8U strat);
+
+/****************************************************************************************
+* RateEwma() - Moving average of the events per second of each bucket.
+*    Parameters: strat is CNT_SOFTWARE, CNT_HARDWARE or CNT_COMBINATION
+*    return: tenths of an event per second
+****************************************************************************************/
+INT32U RateEwma(INT8U strat);
+
+#endif
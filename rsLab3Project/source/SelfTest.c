@@ -0,0 +1,250 @@
+/****************************************************************************************
+* SelfTest.c - Counter rate limits measured with an FTM0 pulse train.
+*
+*   FTM0 makes edge aligned PWM, 50% duty, its output forced low before the
+*   start. Every period the channel match raises a DMA request on eDMA channel
+*   ST_DMA_CH. For the first N requests the TCD writes the running FTM0 SC
+*   value back, then scatter/gather loads a TCD that writes SC with the clock
+*   off. The output rises at the end of each
+*   period and falls at the match, so stopping at match N + 1 leaves exactly
+*   N rising edges, counted by hardware without the CPU.
+*
+*   The test calls CntTask() while a burst runs, like the main loop, and then
+*   waits ST_SETTLE_MS plus the longest moderation holdoff before comparing.
+*   The main loop does not run during the sweep, and CntSelfDrive(FALSE) puts
+*   every count back afterwards, so the history, rate and press statistics
+*   carry on as if no pulse had been sent and none reach the counter log.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "BasicIO.h"
+#include "TimeStamp.h"
+#include "K65TWR_ClkCfg.h"
+#include "Counter.h"
+#include "SelfTest.h"
+
+#define ST_DMA_CH           2U              /* 0 is IntScan, 1 is Counter */
+#define ST_DMA_SLOT         21U             /* DMAMUX source for FTM0 C1V */
+#define ST_DMA_WORD         2U              /* ATTR size code for 32 bits */
+#define ST_CH               1U              /* FTM0 channel on PTA4 */
+#define ST_MAX_PS           7U
+#define ST_MAX_MOD          0xFFFFU
+#define ST_MIN_PULSES       10U
+#define ST_MAX_PULSES       1000U
+#define ST_PULSE_DIV        10U             /* Pulses per burst = f/10, 100ms */
+#define ST_SETTLE_MS        2U
+#define ST_TIMEOUT_MS       20U             /* Beyond the burst length */
+#define ST_MOD_US           100U            /* Holdoff for the moderated mode */
+#define ST_MOD_MAX_US       (ST_MOD_US * 8U)
+#define ST_NUM_FREQ         13U
+#define ST_NAME_COL         10U
+#define ST_HZ_DIGITS        7U
+#define ST_US_PER_SEC       1000000U
+#define ST_US_PER_MS        1000U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+/* eDMA TCD layout, for the scatter/gather TCD in RAM */
+typedef struct{
+    INT32U saddr;
+    INT16U soff;
+    INT16U attr;
+    INT32U nbytes;
+    INT32U slast;
+    INT32U daddr;
+    INT16U doff;
+    INT16U citer;
+    INT32U dlast_sga;
+    INT16U csr;
+    INT16U biter;
+}ST_TCD;
+
+typedef struct{
+    const INT8C *name;
+    INT8U strat;                    /* CNT_xxx counter compared */
+    INT8U isr;                      /* CNT_ISR_xxx handler */
+    INT32U modus;                   /* Moderation holdoff */
+}ST_MODE;
+
+static const ST_MODE stModes[] = {
+    {"sw",        CNT_SOFTWARE,    CNT_ISR_FULL,  0U},
+    {"hw",        CNT_HARDWARE,    CNT_ISR_FULL,  0U},
+    {"cb",        CNT_COMBINATION, CNT_ISR_FULL,  0U},
+    {"hw count",  CNT_HARDWARE,    CNT_ISR_COUNT, 0U},
+    {"hw stamp",  CNT_HARDWARE,    CNT_ISR_STAMP, 0U},
+    {"hw multi",  CNT_HARDWARE,    CNT_ISR_MULTI, 0U},
+    {"hw mod",    CNT_HARDWARE,    CNT_ISR_FULL,  ST_MOD_US},
+};
+#define ST_NUM_MODES    ((INT8U)(sizeof(stModes)/sizeof(stModes[0])))
+
+static const INT32U stFreqs[ST_NUM_FREQ] = {
+    100U, 200U, 500U, 1000U, 2000U, 5000U, 10000U, 20000U, 50000U,
+    100000U, 200000U, 500000U, 1000000U};
+
+static ST_TCD stTcdStop __attribute__ ((aligned(32)));
+static INT32U stScRun;                  /* FTM0 SC while the burst runs */
+static INT32U stScStop;                 /* FTM0 SC to end it */
+
+static INT32U stBurst(INT8U strat, INT32U freq, INT32U pulses);
+static void stWait(INT32U us);
+
+/****************************************************************************************
+* SelfTestRun() - Sends bursts of a known number of pulses at rising
+*                 frequencies through every counting mode and outputs the
+*                 highest frequency each mode counted exactly.
+*    Parameters: isrmode and modus are the CNT_ISR_xxx handler and the
+*                moderation holdoff to put back when the test is done
+****************************************************************************************/
+void SelfTestRun(INT8U isrmode, INT32U modus){
+    INT8U mode;
+    INT8U f;
+    INT32U pulses;
+    INT32U counted;
+    INT32U best;
+    INT8U miss;
+    INT8U col;
+
+    SIM->SCGC6 |= SIM_SCGC6_FTM0_MASK | SIM_SCGC6_DMAMUX_MASK;
+    SIM->SCGC7 |= SIM_SCGC7_DMA_MASK;
+    FTM0->SC = 0;
+    FTM0->MODE = FTM_MODE_WPDIS_MASK;
+    FTM0->OUTINIT = 0;
+    CntSelfDrive(TRUE);
+
+    BIOPutStrg("mode      exact to Hz first miss, counted/sent");
+    BIOOutCRLF();
+    for(mode = 0; mode < ST_NUM_MODES; mode++){
+        CntIsrMode(stModes[mode].isr);
+        CntModerate(stModes[mode].modus);
+        BIOPutStrg(stModes[mode].name);
+        for(col = 0; stModes[mode].name[col] != '\0'; col++){
+        }
+        while(col < ST_NAME_COL){
+            BIOWrite(' ');
+            col++;
+        }
+        best = 0;
+        f = 0;
+        miss = FALSE;
+        while((f < ST_NUM_FREQ) && (miss == FALSE)){
+            pulses = stFreqs[f] / ST_PULSE_DIV;
+            if(pulses < ST_MIN_PULSES){
+                pulses = ST_MIN_PULSES;
+            }else if(pulses > ST_MAX_PULSES){
+                pulses = ST_MAX_PULSES;
+            }else{
+            }
+            counted = stBurst(stModes[mode].strat, stFreqs[f], pulses);
+            if(counted == pulses){
+                best = stFreqs[f];
+                f++;
+            }else{
+                miss = TRUE;
+            }
+        }
+        BIOOutDecWord(best, ST_HZ_DIGITS);
+        if(miss != FALSE){
+            BIOPutStrg("  ");
+            BIOOutDecWord(stFreqs[f], 1U);
+            BIOPutStrg("Hz ");
+            BIOOutDecWord(counted, 1U);
+            BIOWrite('/');
+            BIOOutDecWord(pulses, 1U);
+        }else{
+            BIOPutStrg("  none");
+        }
+        BIOOutCRLF();
+    }
+
+    CntSelfDrive(FALSE);
+    CntIsrMode(isrmode);
+    CntModerate(modus);
+}
+
+/****************************************************************************************
+* stBurst() - Sends one burst and returns how much a counter moved. Private.
+*    Parameters: strat is the CNT_xxx counter to read
+*                freq is the pulse frequency in Hz, pulses the number to send
+****************************************************************************************/
+static INT32U stBurst(INT8U strat, INT32U freq, INT32U pulses){
+    INT32U bus = K65TWR_BusClock();
+    INT32U ps = 0;
+    INT32U mod;
+    INT32U before;
+    INT32U start;
+    INT32U timeout;
+
+    while((ps < ST_MAX_PS) && (((bus >> ps) / freq) > (ST_MAX_MOD + 1U))){
+        ps++;
+    }
+    mod = ((bus >> ps) / freq) - 1U;
+    stScRun = FTM_SC_CLKS(1U) | FTM_SC_PS(ps);
+    stScStop = FTM_SC_PS(ps);
+
+    /* Output low, counter at the start of a period */
+    FTM0->SC = stScStop;
+    FTM0->CNTIN = 0;
+    FTM0->MOD = mod;
+    (void)FTM0->CONTROLS[ST_CH].CnSC;       /* Read then write 0 clears CHF */
+    FTM0->CONTROLS[ST_CH].CnSC = FTM_CnSC_MSB_MASK | FTM_CnSC_ELSB_MASK |
+                                 FTM_CnSC_CHIE_MASK | FTM_CnSC_DMA_MASK;
+    FTM0->CONTROLS[ST_CH].CnV = (mod + 1U) / 2U;
+    FTM0->CNT = 0;
+    FTM0->MODE = FTM_MODE_WPDIS_MASK | FTM_MODE_INIT_MASK;
+
+    /* Requests 1 to pulses keep it running, request pulses + 1 stops it */
+    stTcdStop.saddr = (INT32U)&stScStop;
+    stTcdStop.soff = 0;
+    stTcdStop.attr = DMA_ATTR_SSIZE(ST_DMA_WORD) | DMA_ATTR_DSIZE(ST_DMA_WORD);
+    stTcdStop.nbytes = 4U;
+    stTcdStop.slast = 0;
+    stTcdStop.daddr = (INT32U)&FTM0->SC;
+    stTcdStop.doff = 0;
+    stTcdStop.citer = 1U;
+    stTcdStop.dlast_sga = 0;
+    stTcdStop.csr = DMA_CSR_DREQ_MASK;
+    stTcdStop.biter = 1U;
+
+    DMAMUX->CHCFG[ST_DMA_CH] = 0;
+    DMA0->TCD[ST_DMA_CH].CSR = 0;
+    DMA0->TCD[ST_DMA_CH].SADDR = (INT32U)&stScRun;
+    DMA0->TCD[ST_DMA_CH].SOFF = 0;
+    DMA0->TCD[ST_DMA_CH].ATTR = DMA_ATTR_SSIZE(ST_DMA_WORD) | DMA_ATTR_DSIZE(ST_DMA_WORD);
+    DMA0->TCD[ST_DMA_CH].NBYTES_MLNO = 4U;
+    DMA0->TCD[ST_DMA_CH].SLAST = 0;
+    DMA0->TCD[ST_DMA_CH].DADDR = (INT32U)&FTM0->SC;
+    DMA0->TCD[ST_DMA_CH].DOFF = 0;
+    DMA0->TCD[ST_DMA_CH].CITER_ELINKNO = DMA_CITER_ELINKNO_CITER(pulses);
+    DMA0->TCD[ST_DMA_CH].DLAST_SGA = (INT32U)&stTcdStop;
+    DMA0->TCD[ST_DMA_CH].BITER_ELINKNO = DMA_BITER_ELINKNO_BITER(pulses);
+    DMA0->TCD[ST_DMA_CH].CSR = DMA_CSR_ESG_MASK;
+    DMAMUX->CHCFG[ST_DMA_CH] = DMAMUX_CHCFG_ENBL_MASK | DMAMUX_CHCFG_SOURCE(ST_DMA_SLOT);
+    DMA0->SERQ = ST_DMA_CH;
+
+    stWait(ST_SETTLE_MS * ST_US_PER_MS);
+    before = CntGet(strat);
+    timeout = (INT32U)(((INT64U)pulses * SystemCoreClock) / freq) +
+              ((SystemCoreClock / ST_US_PER_MS) * ST_TIMEOUT_MS);
+    start = TS_GET();
+    FTM0->SC = stScRun;
+    while(((FTM0->SC & FTM_SC_CLKS_MASK) != 0) && ((TS_GET() - start) < timeout)){
+        CntTask();
+    }
+    FTM0->SC = stScStop;
+    DMA0->CERQ = ST_DMA_CH;
+    FTM0->CONTROLS[ST_CH].CnSC = FTM_CnSC_MSB_MASK | FTM_CnSC_ELSB_MASK;
+    stWait((ST_SETTLE_MS * ST_US_PER_MS) + ST_MOD_MAX_US);
+    return CntGet(strat) - before;
+}
+
+/****************************************************************************************
+* stWait() - Waits us microseconds while calling CntTask(). Private.
+****************************************************************************************/
+static void stWait(INT32U us){
+    INT32U start = TS_GET();
+    INT32U cycles = (SystemCoreClock / ST_US_PER_SEC) * us;
+    while((TS_GET() - start) < cycles){
+        CntTask();
+    }
+}
@@ -0,0 +1,24 @@
+/****************************************************************************************
+* SelfTest.h - Counter rate limits measured with an FTM0 pulse train.
+*
+*   PTA4 is switched from GPIO to FTM0 channel 1, so SW2's own pin carries the
+*   pulses and no jumper is needed. Do not press SW2 while the test runs, it
+*   would short the FTM0 output to ground.
+*
+****************************************************************************************/
+#ifndef ST_INCL
+#define ST_INCL
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* SelfTestRun() - Sends bursts of a known number of pulses at rising
+*                 frequencies through every counting mode and outputs the
+*                 highest frequency each mode counted exactly.
+*    Parameters: isrmode and modus are the CNT_ISR_xxx handler and the
+*                moderation holdoff to put back when the test is done
+****************************************************************************************/
+void SelfTestRun(INT8U isrmode, INT32U modus);
+
+#endif
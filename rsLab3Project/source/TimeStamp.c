@@ -0,0 +1,40 @@
+/****************************************************************************************
+* TimeStamp.c - Cycle accurate time stamps from the Cortex-M4 DWT cycle counter.
+*
+*   Time stamps count core clock cycles and wrap every 2^32 cycles (23.8s at
+*   180MHz), so differences of two stamps are valid for intervals shorter than
+*   that. SystemCoreClock is used to convert cycles to time.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "TimeStamp.h"
+
+/****************************************************************************************
+* TSInit() - Enables the DWT cycle counter. Does not reset it so it can be
+*            called again after an earlier start without losing time.
+****************************************************************************************/
+void TSInit(void){
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;     /* Enable DWT */
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+/****************************************************************************************
+* TSCycToUs() - Converts a number of core clock cycles to microseconds.
+****************************************************************************************/
+INT32U TSCycToUs(INT32U cycles){
+    return (INT32U)(((INT64U)cycles * 1000000U)/SystemCoreClock);
+}
+
+/****************************************************************************************
+* TSHzToCyc() - Returns the number of core clock cycles in one period of freq.
+*               Returns 0 for a freq of 0.
+****************************************************************************************/
+INT32U TSHzToCyc(INT32U freq){
+    INT32U cycles;
+    if(freq == 0){
+        cycles = 0;
+    }else{
+        cycles = SystemCoreClock/freq;
+    }
+    return cycles;
+}
@@ -0,0 +1,37 @@
+/****************************************************************************************
+* TimeStamp.h - Cycle accurate time stamps from the Cortex-M4 DWT cycle counter.
+*
+*   Time stamps count core clock cycles and wrap every 2^32 cycles (23.8s at
+*   180MHz), so differences of two stamps are valid for intervals shorter than
+*   that. SystemCoreClock is used to convert cycles to time.
+*
+****************************************************************************************/
+#ifndef TS_INCL
+#define TS_INCL
+
+/****************************************************************************************
+* TS_GET() - Current time stamp in core clock cycles. Safe to use in ISRs.
+****************************************************************************************/
+#define TS_GET()        (DWT->CYCCNT)
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* TSInit() - Enables the DWT cycle counter. Does not reset it so it can be
+*            called again after an earlier start without losing time.
+****************************************************************************************/
+void TSInit(void);
+
+/****************************************************************************************
+* TSCycToUs() - Converts a number of core clock cycles to microseconds.
+****************************************************************************************/
+INT32U TSCycToUs(INT32U cycles);
+
+/****************************************************************************************
+* TSHzToCyc() - Returns the number of core clock cycles in one period of freq.
+*               Returns 0 for a freq of 0.
+****************************************************************************************/
+INT32U TSHzToCyc(INT32U freq);
+
+#endif
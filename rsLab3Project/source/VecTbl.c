@@ -0,0 +1,48 @@
+/****************************************************************************************
+* VecTbl.c - RAM vector table.
+*
+*   VTOR needs the table aligned to the next power of two above its size,
+*   116 words need 512 bytes.
+*
+****************************************************************************************/
+#include "MCUType.h"
+#include "VecTbl.h"
+
+#define VEC_ALIGN           512U
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static VEC_HANDLER vecRam[VEC_NUM] __attribute__ ((aligned(VEC_ALIGN)));
+
+/****************************************************************************************
+* VecInit() - Copies the active vector table to RAM and switches VTOR to it.
+*             Interrupts stay enabled, the copy is complete before the switch.
+****************************************************************************************/
+void VecInit(void){
+    const VEC_HANDLER *active = (const VEC_HANDLER *)SCB->VTOR;
+    INT32U i;
+    if(active != vecRam){
+        for(i = 0; i < VEC_NUM; i++){
+            vecRam[i] = active[i];
+        }
+        __DSB();
+        SCB->VTOR = (INT32U)vecRam;
+        __DSB();
+        __ISB();
+    }else{
+    }
+}
+
+/****************************************************************************************
+* VecSet() - Installs handler for irq in the RAM vector table.
+*    return: the handler it replaced
+****************************************************************************************/
+VEC_HANDLER VecSet(IRQn_Type irq, VEC_HANDLER handler){
+    VEC_HANDLER old;
+    old = vecRam[VEC_NUM_CORE + (INT32S)irq];
+    vecRam[VEC_NUM_CORE + (INT32S)irq] = handler;
+    /* The write must land before the next exception entry fetches it */
+    __DSB();
+    return old;
+}
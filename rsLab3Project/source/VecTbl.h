@@ -0,0 +1,34 @@
+/****************************************************************************************
+* VecTbl.h - RAM vector table.
+*
+*   VecInit() copies the flash vector table to RAM and points VTOR at the copy,
+*   after which VecSet() can replace any interrupt handler while the program
+*   runs. Handlers are stored with their Thumb bit, so any function address can
+*   be passed.
+*
+****************************************************************************************/
+#ifndef VEC_INCL
+#define VEC_INCL
+
+#define VEC_NUM_CORE        16U     /* Stack pointer and exceptions */
+#define VEC_NUM_IRQ         100U    /* Last IRQ is CAN1_Wake_Up_IRQn */
+#define VEC_NUM             (VEC_NUM_CORE + VEC_NUM_IRQ)
+
+typedef void (*VEC_HANDLER)(void);
+
+/****************************************************************************************
+* Public Function Prototypes
+****************************************************************************************/
+/****************************************************************************************
+* VecInit() - Copies the active vector table to RAM and switches VTOR to it.
+*             Interrupts stay enabled, the copy is complete before the switch.
+****************************************************************************************/
+void VecInit(void);
+
+/****************************************************************************************
+* VecSet() - Installs handler for irq in the RAM vector table.
+*    return: the handler it replaced
+****************************************************************************************/
+VEC_HANDLER VecSet(IRQn_Type irq, VEC_HANDLER handler);
+
+#endif
@@ -3,8 +3,11 @@
 *   Program allows user to use three different counter implementations
 *   all of which are incremented by SW2 being pressed. The implementations are
 *   software only, hardware interrupts only, and hardware and software combined.
-*   The user types s, h, or b, and then hits enter to go into a counter state,
-*   and presses q to exit a counter state.
+*   All three count in the background at all times, including while a command
+*   is being typed. The user types s, h, or b, and then hits enter to display
+*   that counter's accumulated total, and presses q to exit the display.
+*   Typing c shows all three side by side with the amount they disagree by.
+*   Commands are looked up in CmdTable, type help for the full list.
 *
 * Robert Sanborn, 10/29/2018
 *
@@ -12,75 +15,455 @@
 #include "MCUType.h"               /* Include project header file                      */
 #include "BasicIO.h"
 #include "K65TWR_ClkCfg.h"
+#include "Counter.h"
+#include "CmdParse.h"
+#include "TimeStamp.h"
+#include "BootProf.h"
+#include "MemBench.h"
+#include "ChkSum.h"
+#include "IntScan.h"
+#include "PinCfg.h"
+#include "VecTbl.h"
+#include "MemCfg.h"
+#include "RamFunc.h"
+#include "CpuLoad.h"
+#include "SelfTest.h"
+#include "PressStat.h"
+#include "Rate.h"
+#include "History.h"
+#include "Quant.h"
+#include "FreqMeter.h"
+#include "Persist.h"
 
 #define COMMAND_PARSE             'q'
 #define SOFTWARE_COUNTER          's'
 #define HARDWARE_COUNTER          'h'
 #define COMBINATION_COUNTER       'b'
+#define COMPARE_COUNTERS          'c'
+#define CHKSUM_RANGE              'r'
+#define FILTER_EXPERIMENT         'f'
+#define LOOP_RATE                 'l'
+#define CPU_LOAD                  'u'
+#define HIST_EXPORT               'x'
+#define FREQ_METER                'm'
 
 #define ZERO_ADDR 0x00000000
-#define HIGH_ADDR 0x001FFFFF
-#define USER_IN_LN 2U
+#define HIGH_ADDR 0x001FBFFF     /* The counter log at PERSIST_BASE is above */
 
-#define INVALID_INPUT(x) ((x != SOFTWARE_COUNTER) && (x != HARDWARE_COUNTER) && (x != COMBINATION_COUNTER))
-/* For PORTA SW2 interrupt flag*/
-#define SW2_BIT          (1U << 4U)
-#define SW2_ISF          (PORTA->ISFR & SW2_BIT)
-#define SW2_CLR_ISF()    (PORTA->ISFR = SW2_BIT)
-#define SW2_INPUT        (GPIOA->PDIR & SW2_BIT)
+/* Boot checksum options. Image bounds it by the linker image instead of
+ * ZERO_ADDR-HIGH_ADDR, skip accounts for erased sectors without summing them.
+ * Skip gives the same checksum as a full scan. */
+#define BOOT_CS_IMAGE      FALSE
+#define BOOT_CS_SKIP       TRUE
 
+/* csmode settings */
+#define CS_MODE_FULL       0U
+#define CS_MODE_SKIP       1U
+#define CS_NUM_MODE        2U
+#define CS_RANGE_STEP      4096U  /* Bytes per main loop pass for cs */
 
+#define FILT_BUS_WIDTH     31U    /* Default digital filter widths, filter clocks */
+#define FILT_LPO_WIDTH     10U
 
-#define ISF_DISABLE        0U
-#define ISF_INT_REDGE      9U     /* Set ISF to falling edge*/
-#define MUX_GPIO_ENABLE    1U
-#define PIN_4              4U
-#define LEADING_ZEROS      1U    /* Leading zeros*/
+#define MOD_MAX_US         100000U /* Longest SW2 moderation holdoff */
+
+#define LEADING_ZEROS      5U    /* Minimum digits shown for a count*/
 
 /**********************************************************************************
 * Function Prototypes
 **********************************************************************************/
 
 /**********************************************************************************
-* PORTA-IRQHandler()
+* OutChkSum()
+*
+* Description:  Outputs the checksum of a memory block in the form
+*               CS : LLLLLLLL-HHHHHHHH XXXX where LLLLLLLL is the low address,
+*               HHHHHHHH is the high address and XXXX is the check sum.
+*               Does not end the line.
+*
+* Return Value: none
+*
+* Arguments:    lowaddr and highaddr are the first and last address of the block
+*               sum is the check sum, digits is 4 or 8 hex digits
+**********************************************************************************/
+static void OutChkSum(INT32U lowaddr, INT32U highaddr, INT32U sum, INT8U digits);
+
+
+/**********************************************************************************
+* CsRangeBegin()
+*
+* Description:  Starts checksumming a memory block with the algorithm, kernel
+*               and mode selected by the csalg and csmode commands. The block is
+*               handled CS_RANGE_STEP bytes per main loop pass in the
+*               CHKSUM_RANGE state, which outputs the result.
+*
+* Return Value: the next program state
+*
+* Arguments:    lowaddr and highaddr are the first and last address of the block
+**********************************************************************************/
+static INT8C CsRangeBegin(INT32U lowaddr, INT32U highaddr);
+
+
+/**********************************************************************************
+* CsRangeOut()
 *
-* Description:  clears ISF for SW2 immediately then updates
-*               global variable Sw_Cnt_Globe so that counter display
-*               for hardware counter can be incremented
+* Description:  Outputs the CS line for the finished cs block followed by the
+*               elapsed milliseconds, the bytes per second and, in skip mode,
+*               the number of erased bytes skipped.
 *
 * Return Value: none
 *
 * Arguments:    none
 **********************************************************************************/
-void PORTA_IRQHandler(void);
+static void CsRangeOut(void);
 
 
 /**********************************************************************************
-* GPIOAPeriphIni(INT8U pin_num, INT8U mux, INT8U irq_code)
+* BootChkSum()
 *
-* Description:  Initializes PORTA Peripheral
+* Description:  Outputs the boot checksum. A value cached by this build on an
+*               earlier boot is shown right away and rescanned in the background
+*               by BootChkSumTask(), otherwise the block is scanned now and the
+*               result cached. A mismatch latched by an earlier rescan is
+*               reported first, on every boot until csclear.
 *
 * Return Value: none
 *
-* Arguments:    INT8U pin_num,   The PCR number of the Peripheral
-*               INT8U irq_code,  The interrupt request code
-*               INT8U mux,       The Pin Mux Control code
+* Arguments:    none
 **********************************************************************************/
-static void GPIOAPeriphIni(INT8U pin_num, INT8U mux, INT8U irq_code);
+static void BootChkSum(void);
 
 
 /**********************************************************************************
-* CalcChkSum() -ascertains checksum for memory block indicated by starting and
-*               ending addresses
+* BootChkSumTask()
 *
-* Description:
+* Description:  Runs the background rescan of a cached boot checksum. Sounds an
+*               alert if the memory no longer matches the cached value.
+*               Call once per main loop pass.
 *
-* Return Value:
+* Return Value: TRUE while the rescan is running
 *
-* Arguments:    startaddr is pointer to the initial address of the memory block
-*               endaddr is the pointer to the last address of the memory block
+* Arguments:    none
 **********************************************************************************/
-static INT16U CalcChkSum(INT8U *startaddr, INT8U *endaddr);
+static INT8U BootChkSumTask(void);
+
+
+/**********************************************************************************
+* ScanOut()
+*
+* Description:  Outputs a line for each region the integrity scanner finishes,
+*               the CS line followed by the region name, algorithm and cycles.
+*               Call once per main loop pass.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void ScanOut(void);
+
+
+/**********************************************************************************
+* CompareOut()
+*
+* Description:  Outputs one comparison line with the count each strategy has
+*               accumulated since CmpBase was taken and the divergence, the
+*               largest count minus the smallest count. Ends with '\r' so
+*               the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void CompareOut(void);
+
+
+/**********************************************************************************
+* LoadOut()
+*
+* Description:  Outputs the CPU load line for the last one second window, the
+*               share of each category and the total of all but idle. Ends
+*               with '\r' so the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void LoadOut(void);
+
+
+/**********************************************************************************
+* StatRowOut()
+*
+* Description:  Outputs one line of the stats table: the series name, the
+*               number of samples and mean, std dev, min, max and RMS in
+*               milliseconds with three decimals.
+*
+* Return Value: none
+*
+* Arguments:    name is the series name, ser is STAT_HOLD or STAT_GAP
+**********************************************************************************/
+static void StatRowOut(const INT8C *name, INT8U ser);
+
+
+/**********************************************************************************
+* FiltRowOut()
+*
+* Description:  Outputs the filter experiment line for the active filter: the
+*               filter, its width, the debounced presses, the ISR entries and
+*               the ISR entries that were not presses, all counted since the
+*               filter was selected. Ends with '\r' so the next line
+*               overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void FiltRowOut(void);
+
+
+/**********************************************************************************
+* DispStart()
+*
+* Description:  Selects the counter shown by the counter display states and
+*               outputs its accumulated total
+*
+* Return Value: the counter display state for strat
+*
+* Arguments:    strat is the counter to display
+**********************************************************************************/
+static INT8C DispStart(INT8U strat);
+
+
+/**********************************************************************************
+* DispDue()
+*
+* Description:  Limits display refreshes to the rate set by the rate command
+*
+* Return Value: TRUE if the display may be refreshed now
+*
+* Arguments:    none
+**********************************************************************************/
+static INT8U DispDue(void);
+
+
+/**********************************************************************************
+* DispOut()
+*
+* Description:  Outputs the displayed count followed by its rate over the
+*               sliding window and its moving average, in events per second
+*               with one decimal. Ends with '\r' so the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void DispOut(void);
+
+/**********************************************************************************
+* RateOut()
+*
+* Description:  Outputs a rate in tenths as a number with one decimal
+*
+* Return Value: none
+*
+* Arguments:    tenths is the rate in tenths of an event per second
+**********************************************************************************/
+static void RateOut(INT32U tenths);
+
+
+/**********************************************************************************
+* HistRowOut()
+*
+* Description:  Outputs one history entry as a line of comma separated
+*               values: c,<second>,<count> for a counts interval that is not
+*               zero or e,<seconds with six decimals> for a press. Entries
+*               outside the selected seconds are left out. Counts the lines.
+*
+* Return Value: none
+*
+* Arguments:    sec and val are the entry as read by HistNext()
+**********************************************************************************/
+static void HistRowOut(INT32U sec, INT64U val);
+
+
+/**********************************************************************************
+* HistInfoOut()
+*
+* Description:  Outputs the blocks, entries and encoded bytes held by each
+*               history series and the seconds they span
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void HistInfoOut(void);
+
+
+/**********************************************************************************
+* QuantRowOut()
+*
+* Description:  Outputs one line of the quant table: the sketch name, its
+*               number of samples and its p50, p90, p99 and p99.9 in
+*               microseconds with three decimals
+*
+* Return Value: none
+*
+* Arguments:    name is the sketch name, sk is QUANT_EDGE or QUANT_LAT
+**********************************************************************************/
+static void QuantRowOut(const INT8C *name, INT8U sk);
+
+
+/**********************************************************************************
+* FreqOut()
+*
+* Description:  Outputs a frequency meter result: Hz with three decimals, the
+*               measurement method and the edges it is based on. Ends with
+*               '\r' so the next result overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    res is the result from FreqGet()
+**********************************************************************************/
+static void FreqOut(const FREQ_RESULT *res);
+
+
+/**********************************************************************************
+* Command handlers - one per CmdTable entry. Each returns the next program state.
+**********************************************************************************/
+static INT8C CmdBaud(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdBoot(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCombination(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCompare(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdChkSum(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCsAlg(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCsBench(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCsClear(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCsImage(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdCsMode(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdClock(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdHardware(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdFilter(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdFiltExp(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdFreq(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdHelpOut(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdHist(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdInitBench(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdIsr(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdIsrBench(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdLoad(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdLoops(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdMemBench(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdMemCfg(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdModerate(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdPersist(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdQuant(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdRate(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdScan(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdSelfTest(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdStats(const CMD_ARG *args, INT8U nargs);
+static INT8C CmdSoftware(const CMD_ARG *args, INT8U nargs);
+
+
+/**********************************************************************************
+* Command Table - must stay sorted by verb for CmdFind()
+**********************************************************************************/
+static const CMD_ENTRY CmdTable[] = {
+    {"b",    {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCombination, "",
+        "Show the hardware and software combination counter"},
+    {"baud", {CMD_ARG_DEC,  CMD_ARG_NONE, CMD_ARG_NONE}, 1U, CmdBaud,        "<bps>",
+        "Change the terminal bit rate"},
+    {"boot", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdBoot,        "",
+        "Show the boot phase profile"},
+    {"c",    {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCompare,     "",
+        "Compare all three counters side by side"},
+    {"clk",  {CMD_ARG_STR,  CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdClock,       "[fei|pee|blpi|pee120]",
+        "Show or switch the clock profile"},
+    {"cs",   {CMD_ARG_HEX,  CMD_ARG_HEX,  CMD_ARG_NONE}, 2U, CmdChkSum,      "<low> <high>",
+        "Checksum of a memory block, hex addresses"},
+    {"csalg", {CMD_ARG_STR, CMD_ARG_STR,  CMD_ARG_NONE}, 0U, CmdCsAlg,       "[alg] [sw|hw]",
+        "Show or select the checksum algorithm and kernel"},
+    {"csbench", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCsBench, "",
+        "Checksum throughput of every algorithm"},
+    {"csclear", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCsClear, "",
+        "Forget the cached boot checksum and a latched mismatch"},
+    {"csimage", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCsImage, "",
+        "Checksum of the linked image only"},
+    {"csmode", {CMD_ARG_STR, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdCsMode,    "[full|skip]",
+        "Sum erased sectors or skip them"},
+    {"f",    {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdFiltExp,     "",
+        "SW2 filter experiment, n for the next filter"},
+    {"filter", {CMD_ARG_STR, CMD_ARG_DEC, CMD_ARG_NONE}, 0U, CmdFilter,     "[off|passive|bus|lpo] [width]",
+        "Show or select the SW2 input filter"},
+    {"freq", {CMD_ARG_DEC,  CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdFreq,        "[gate ms]",
+        "Frequency of the pulses on PTC5"},
+    {"h",    {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdHardware,    "",
+        "Show the hardware only counter"},
+    {"help", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdHelpOut,     "",
+        "List the commands"},
+    {"hist", {CMD_ARG_STR,  CMD_ARG_DEC,  CMD_ARG_DEC},  0U, CmdHist,        "[counts <s>|events <from> <to>|export|clear]",
+        "Counter history kept in RAM"},
+    {"initbench", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdInitBench, "",
+        "Time startup section copy and zero fill"},
+    {"isr",  {CMD_ARG_STR,  CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdIsr,         "[full|count|stamp|multi]",
+        "Show or select the SW2 handler, full is in SRAM_L if RAMFUNC_EN"},
+    {"isrbench", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdIsrBench, "",
+        "SW2 handler latency from RAM and flash"},
+    {"load", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdLoad,        "",
+        "Live CPU load by category, once a second"},
+    {"loops", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdLoops,      "",
+        "Main loop passes in one second"},
+    {"membench", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdMemBench, "",
+        "Time checksum, output and SW2 ISR per cache setting"},
+    {"memcfg", {CMD_ARG_HEX, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdMemCfg,    "[bits]",
+        "Show or set caches: 1 LMEM, 2 FMC, 4 prefetch"},
+    {"mod",  {CMD_ARG_DEC,  CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdModerate,    "[us]",
+        "Show or set the SW2 interrupt holdoff, 0 = off"},
+    {"persist", {CMD_ARG_STR, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdPersist,  "[save]",
+        "Counter checkpoints in flash, save takes one now"},
+    {"quant", {CMD_ARG_STR, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdQuant,       "[lat|clear]",
+        "Edge interval and latency percentiles"},
+    {"rate", {CMD_ARG_DEC,  CMD_ARG_NONE, CMD_ARG_NONE}, 1U, CmdRate,        "<per sec>",
+        "Max counter display refreshes per second, 0 = no limit"},
+    {"s",    {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdSoftware,    "",
+        "Show the software only counter"},
+    {"scan", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdScan,        "",
+        "Checksum every memory region in the background"},
+    {"selftest", {CMD_ARG_NONE, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdSelfTest, "",
+        "Highest exact rate of each counter, FTM0 drives SW2"},
+    {"stats", {CMD_ARG_STR, CMD_ARG_NONE, CMD_ARG_NONE}, 0U, CmdStats,       "[clear]",
+        "SW2 hold time and press interval statistics"},
+};
+#define CMD_TABLE_LN    ((INT8U)(sizeof(CmdTable)/sizeof(CmdTable[0])))
+
+/* Clock profile names, indexed by K65TWR_CLK_xxx */
+static const INT8C *const ClkNames[K65TWR_CLK_NUM] = {"fei", "pee", "blpi", "pee120"};
+
+/* Checksum kernel names, indexed by CS_KERN_xxx */
+static const INT8C *const KernNames[CS_NUM_KERN] = {"sw", "hw"};
+
+/* Checksum modes, indexed by CS_MODE_xxx */
+static const INT8C *const ModeNames[CS_NUM_MODE] = {"full", "skip"};
+
+/* SW2 handler names, indexed by CNT_ISR_xxx */
+static const INT8C *const IsrNames[CNT_NUM_ISR] = {"full", "count", "stamp", "multi"};
+
+/* stats options */
+static const INT8C *const StatWords[1] = {"clear"};
+
+/* persist options */
+static const INT8C *const PersistWords[1] = {"save"};
+
+/* quant options */
+static const INT8C *const QuantWords[2] = {"lat", "clear"};
+
+/* quant percentiles in parts per 10000 */
+static const INT16U QuantPcts[4] = {5000U, 9000U, 9900U, 9990U};
+
+/* hist options */
+static const INT8C *const HistWords[4] = {"counts", "events", "export", "clear"};
+
+/* SW2 filter names, indexed by CNT_FILT_xxx */
+static const INT8C *const FiltNames[CNT_NUM_FILT] = {"off", "passive", "bus", "lpo"};
 
 
 /**********************************************************************************
@@ -88,238 +471,1408 @@ static INT16U CalcChkSum(INT8U *startaddr, INT8U *endaddr);
 **********************************************************************************/
 
 static const INT8C InitialMessage[] = {
-    "Please enter a command key then press enter. \n\r"
-    "Type 's' to demonstrate the software only counter.\n\r"
-    "Type 'b' to demonstrate the hardware and software combination counter.\n\r"
-    "Type 'h' to demonstrate the hardware only counter.\n\r"
-    "To terminate any counter protocol just press 'q'.\n\r"
+    "Please enter a command then press enter. Type 'help' for a list.\n\r"
+    "Type 's', 'h' or 'b' to show the software, hardware or combination counter.\n\r"
+    "Type 'c' to compare all three counters side by side.\n\r"
+    "To leave any counter display just press 'q'.\n\r"
     };
 
 static const INT8C ErrorMessage[] = {
-    "Please type only one letter and then press enter. \n\r"};
+    "Command too long. \n\r"};
 
 static const INT8C ErrorMessage2[] = {
-    "Must type s, h, or b for selection.\n\r"};
+    "Unknown command, type help for a list.\n\r"};
+
+static const INT8C CompareHeader[] = {
+    "SW         HW         CB         DIV\n\r"};
+
+static const INT8C FiltHeader[] = {
+    "Press SW2 a few times with each filter, n selects the next filter.\n\r"
+    "filter  width  presses        isr      extra\n\r"};
+
+static const INT8C LoadHeader[] = {
+    "CPU load, percent of each second\n\r"
+    "  isr  uart  poll  idle  busy\n\r"};
+
+static const INT8C CsAlertMessage[] = {
+    "\a\a\a*** CHECKSUM MISMATCH: memory does not match the cached boot checksum ***\n\r"};
 
 
 /**********************************************************************************
 * Program
 **********************************************************************************/
-static INT16U Sw_Cnt_Globe;            /* Global count variable for hardware*/
+static INT8U DispStrat;                 /* Counter shown by the display states */
+static INT32U DispCnt;                  /* Last count displayed */
+static INT32U DispRate;                 /* Refreshes per second, 0 = no limit */
+static INT32U DispPeriod;               /* Cycles between refreshes, 0 = no limit */
+static INT32U DispLast;                 /* Time stamp of the last refresh */
+static INT32U CmpBase[CNT_NUM_STRAT];   /* Counts when compare was entered */
+static INT32U CmpLast[CNT_NUM_STRAT];   /* Counts last compared */
+static INT8U CsAlgSel = CS_ALG_SUM16;   /* Algorithm used by the cs command */
+static INT8U CsKernSel = CS_KERN_SW;    /* Kernel used by the cs command */
+static INT8U CsModeSel = CS_MODE_SKIP;  /* Erased sector handling for cs */
+static INT8U FiltSel = CNT_FILT_OFF;   /* SW2 filter */
+static INT8U FiltWidth[CNT_NUM_FILT] = {0U, 0U, FILT_BUS_WIDTH, FILT_LPO_WIDTH};
+static INT32U ModUs;                    /* SW2 interrupt holdoff */
+static INT8U IsrSel = CNT_ISR_FULL;     /* SW2 interrupt handler */
+static INT32U LoopCnt;                  /* Main loop passes */
+static INT32U LoopBase;                 /* LoopCnt at the start of loops */
+static INT32U LoopStart;                /* Time stamp at the start of loops */
+static INT32U FiltBase[2];              /* Presses and ISR entries when selected */
+static INT32U FiltLast[2];              /* Presses and ISR entries last shown */
+static INT32U BootCsLow;                /* Boot checksum range */
+static struct{                          /* Block being checksummed by cs */
+    CS_RANGE rng;
+    INT32U low;
+    INT32U high;
+    INT64U cycles;                      /* Elapsed, can pass 2^32 on long blocks */
+    INT32U last;                        /* Time stamp at the last step */
+}CsRangeSel;
+static INT32U BootCsHigh;
+static HIST_ITER HistIt;                /* Entry being exported */
+static INT8U HistBoth;                  /* Export events after counts */
+static INT32U HistFrom;                 /* Seconds selected for export */
+static INT32U HistTo;
+static INT32U HistLines;                /* Lines exported */
 
 void main(void){
     INT8C prg_state;
-    INT8C userentry[USER_IN_LN];
-    INT8U toolong;
-    INT32U lastsw;
-    INT32U currsw;
-    INT16U sw_cnt;
+    INT8C userentry[CMD_LINE_LN];
+    INT8U strg_stat;
+    INT32U curr_cnt;
+    INT8U strat;
+    INT8U cmp_chg;
+    INT8U done;
+    INT32U now;
+    INT8U idle;
+    INT8U window;
+    INT32U hist_sec;
+    INT64U hist_val;
+    FREQ_RESULT freq_res;
+    PERSIST_INFO persist_info;
 
+    BootProfMark(BP_MAIN);
     K65TWR_BootClock();
+    MemCfgSet(MEMCFG_BOOT);
+    BootProfMark(BP_CLOCK);
     BIOOpen(BIO_BIT_RATE_9600);            /* Initialize Serial Port  */
+    BootProfMark(BP_BIOOPEN);
+    TSInit();
 
-    /* Output Low Address, High Address, and check sum to terminal
-     * in the form LLLLLLLL-HHHHHHHH XXXX where, LLLLLLLL
-     * is the low address HHHHHHHH is the high address and
-     *  XXXX is the check sum */
-    BIOPutStrg("CS : ");
-    BIOOutHexWord(ZERO_ADDR);
-    BIOPutStrg("-");
-    BIOOutHexWord(HIGH_ADDR);
-    BIOPutStrg(" ");
-    BIOOutHexHWord(CalcChkSum( ((void *)ZERO_ADDR),((void *)HIGH_ADDR) ) );
-    BIOOutCRLF();
+    BootChkSum();
+    BootProfMark(BP_CHKSUM);
+
+    /* Start all counters, they run from here on regardless of state */
+    VecInit();
+    CntInit();
+    PersistInit();
+    PersistInfo(&persist_info);
+    if(persist_info.off != FALSE){
+        BIOPutStrg("The image reaches the counter log, counts are not saved.");
+        BIOOutCRLF();
+    } else {}
+    LoadInit();
+    RateInit();
+    HistInit();
 
     /* Output user prompt */
     BIOPutStrg(InitialMessage);
+    BIOOutCRLF();
+    BootProfMark(BP_PROMPT);
+    BootProfOut();
+    BIOOutCRLF();
 
     prg_state = COMMAND_PARSE;
+    DispStrat = CNT_SOFTWARE;
+    DispCnt = 0;
+    DispRate = 0;
+    DispPeriod = 0;
+    DispLast = TS_GET();
+    window = FALSE;
 
     while (1U){
+        LoopCnt++;
+        CntTask();
+        StatTask();
+        RateTask();
+        QuantTask();
+        HistTask();
+        idle = (INT8U)((BootChkSumTask() == FALSE) && (ScanBusy() == FALSE));
+        ScanOut();
+        if((prg_state != CHKSUM_RANGE) && (idle != FALSE)){
+            /* cs, the boot rescan and the scan read the log's flash block,
+             * which a flash command must not overlap */
+            PersistTask();
+        } else {}
+
         switch(prg_state){
 
         case(COMMAND_PARSE):
-            BIOOutCRLF();
-            toolong = BIOGetStrg(USER_IN_LN, userentry);
-            if(toolong){
+            /* Does not block so the counters keep running while typing */
+            strg_stat = BIOGetStrgNB(CMD_LINE_LN, userentry);
+            if(strg_stat == BIO_STRG_PENDING){
+            } else if(strg_stat == BIO_STRG_TOOLONG){
+                idle = FALSE;
                 BIOPutStrg(ErrorMessage);
+                BIOOutCRLF();
             } else {
-               /* Check if user entered s, h, or b,
-                *  if not stay in Command Parse     */
-               if ( INVALID_INPUT(userentry[0U]) ) {
-                   /*Stay in Command Parse*/
+               idle = FALSE;
+               /* Look the command up, stay in Command Parse if unknown */
+               switch(CmdExecute(CmdTable, CMD_TABLE_LN, userentry, &prg_state)){
+               case(CMD_UNKNOWN):
                    BIOPutStrg(ErrorMessage2);
-               } else {
-                   prg_state = userentry[0U];
+                   BIOOutCRLF();
+                   break;
+               case(CMD_OK):
+                   if(prg_state == COMMAND_PARSE){
+                       BIOOutCRLF();
+                   } else {}
+                   break;
+               default:
+                   break;
                }
             }
             break;
 
         case(SOFTWARE_COUNTER):
-            sw_cnt = 0;
-            /* Begin Outputting Counter */
-            BIOOutDecHWord(sw_cnt, LEADING_ZEROS);
-            BIOWrite('\r'); //>>> should send \n as well
-
-            /* Initialize SW2 Peripheral, no interrupt enabled  */
-            GPIOAPeriphIni(PIN_4, MUX_GPIO_ENABLE, ISF_DISABLE);
-            lastsw |= SW2_BIT; /*Preset to 1 b/c GPIOA_PDIR is active low */
-            lastsw &= SW2_BIT;
-            while (BIORead() != 'q') {
-                /* SW2 is active low thus detect rising edge
-                 *  for when user stops pressing SW2 */
-                currsw = SW2_INPUT;
-                if ((currsw == SW2_BIT) && (lastsw == 0x00)) {
-                    sw_cnt++;
-                    BIOOutDecHWord(sw_cnt, LEADING_ZEROS);
-                    BIOWrite('\r');
+        case(HARDWARE_COUNTER):
+        case(COMBINATION_COUNTER):
+            /* The display only selects a counter, counting is done by CntTask()
+             * and PORTA_IRQHandler() in every state. The rates also change
+             * while the count does not, so they are refreshed every second */
+            curr_cnt = CntGet(DispStrat);
+            if (((curr_cnt != DispCnt) || (window != FALSE)) && (DispDue() != FALSE)){
+                DispCnt = curr_cnt;
+                DispOut();
+            } else {}
+
+            if (BIORead() == 'q'){
+                BIOOutCRLF();
+                BIOOutCRLF();
+
+                /* Output user prompt and return to Command Parse */
+                BIOPutStrg(InitialMessage);
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
+            break;
+
+        case(COMPARE_COUNTERS):
+            /* Refresh the line only when a counter moved */
+            cmp_chg = FALSE;
+            for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+                curr_cnt = CntGet(strat);
+                if(curr_cnt != CmpLast[strat]){
+                    cmp_chg = TRUE;
                 } else {}
-                lastsw = currsw;
             }
-            BIOOutCRLF();
-            BIOOutCRLF();
+            if((cmp_chg != FALSE) && (DispDue() != FALSE)){
+                CompareOut();
+            } else {}
 
-            /* Output user prompt and return to Command Parse */
-            BIOPutStrg(InitialMessage);
-            prg_state = COMMAND_PARSE;
+            if (BIORead() == 'q'){
+                BIOOutCRLF();
+                BIOOutCRLF();
+
+                /* Output user prompt and return to Command Parse */
+                BIOPutStrg(InitialMessage);
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
             break;
 
-        case(HARDWARE_COUNTER):
-            sw_cnt = 0;
-            Sw_Cnt_Globe = 0;
-
-            /* Begin Outputting Counter */
-            BIOOutDecHWord(Sw_Cnt_Globe, LEADING_ZEROS);
-            BIOWrite('\r');
-
-            /* Initialize Interrupt for SW2 Rising Edge*/
-            SW2_CLR_ISF();
-            NVIC_ClearPendingIRQ(PORTA_IRQn);
-            NVIC_EnableIRQ(PORTA_IRQn);
-
-            /* SW2 is active low thus detect rising edge
-             *  for when user stops pressing SW2 */
-            GPIOAPeriphIni(PIN_4, MUX_GPIO_ENABLE, ISF_INT_REDGE);
-
-            /* while user has not entered 'q' continue
-             *  to output counter to terminal*/
-            while (BIORead() != 'q'){
-                if (sw_cnt != Sw_Cnt_Globe){
-                    sw_cnt = Sw_Cnt_Globe;
-                    BIOOutDecHWord(Sw_Cnt_Globe, LEADING_ZEROS);
-                    BIOWrite('\r');
-                } else {}
+        case(CHKSUM_RANGE):
+            /* One step per pass so counting goes on during long blocks */
+            idle = FALSE;
+            done = CsRangeStep(&CsRangeSel.rng, CS_RANGE_STEP);
+            now = TS_GET();
+            CsRangeSel.cycles += now - CsRangeSel.last;
+            CsRangeSel.last = now;
+            if(done != FALSE){
+                CsRangeOut();
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else if(BIORead() == 'q'){
+                BIOPutStrg("Checksum stopped at ");
+                BIOOutHexWord(CsRangeSel.rng.addr);
+                BIOOutCRLF();
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
+            break;
+
+        case(FILTER_EXPERIMENT):
+            if(((CntPresses() != FiltLast[0]) || (CntIsrEntries() != FiltLast[1])) &&
+               (DispDue() != FALSE)){
+                FiltRowOut();
+            } else {}
+
+            switch(BIORead()){
+            case('n'):
+                /* Keep the finished row, count the next filter from zero */
+                FiltRowOut();
+                BIOOutCRLF();
+                FiltSel = (INT8U)((FiltSel + 1U) % CNT_NUM_FILT);
+                CntFilter(FiltSel, FiltWidth[FiltSel]);
+                FiltBase[0] = CntPresses();
+                FiltBase[1] = CntIsrEntries();
+                FiltRowOut();
+                break;
+            case('q'):
+                BIOOutCRLF();
+                BIOOutCRLF();
+                BIOPutStrg(InitialMessage);
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+                break;
+            default:
+                break;
             }
-            BIOOutCRLF();
-            BIOOutCRLF();
-            NVIC_DisableIRQ(PORTA_IRQn);
+            break;
 
-            /* Output user prompt and return to Command Parse */
-            BIOPutStrg(InitialMessage);
-            prg_state = COMMAND_PARSE;
+        case(LOOP_RATE):
+            if((TS_GET() - LoopStart) >= SystemCoreClock){
+                BIOPutStrg("Main loop: ");
+                BIOOutDecWord(LoopCnt - LoopBase, 1U);
+#if RAMFUNC_EN
+                BIOPutStrg(" passes/s, hot path in SRAM_L");
+#else
+                BIOPutStrg(" passes/s, hot path in flash");
+#endif
+                BIOOutCRLF();
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
             break;
 
-        case(COMBINATION_COUNTER):
-            sw_cnt = 0;
-
-            /* SW2 is active low thus detect rising edge
-             *  for when user stops pressing SW2 */
-            GPIOAPeriphIni(PIN_4, MUX_GPIO_ENABLE, ISF_INT_REDGE);
-            SW2_CLR_ISF();
-
-            BIOOutDecHWord(sw_cnt, LEADING_ZEROS);
-            BIOWrite('\r');
-
-            while(BIORead() != 'q'){
-                /* When Interrupt Flag is set, clear it, & update counter*/
-                if (SW2_ISF != 0){
-                    SW2_CLR_ISF();
-                    sw_cnt++;
-                    BIOOutDecHWord(sw_cnt, LEADING_ZEROS);
-                    BIOWrite('\r');
-                } else {}
+        case(CPU_LOAD):
+            if(window != FALSE){
+                LoadOut();
+            } else {}
+            if(BIORead() == 'q'){
+                BIOOutCRLF();
+                BIOOutCRLF();
+                BIOPutStrg(InitialMessage);
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
+            break;
+
+        case(HIST_EXPORT):
+            /* One entry per pass, so counting and the history go on */
+            idle = FALSE;
+            if(HistNext(&HistIt, &hist_sec, &hist_val) != FALSE){
+                HistRowOut(hist_sec, hist_val);
+            } else if((HistIt.ser == HIST_COUNTS) && (HistBoth != FALSE)){
+                HistIterStart(HIST_EVENTS, &HistIt);
+            } else {
+                BIOOutDecWord(HistLines, 1U);
+                BIOPutStrg(" lines");
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
             }
+            if((prg_state == HIST_EXPORT) && (BIORead() == 'q')){
+                BIOPutStrg("Export stopped");
+                BIOOutCRLF();
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
+            break;
+
+        case(FREQ_METER):
+            if(FreqGet(&freq_res) != FALSE){
+                FreqOut(&freq_res);
+            } else {}
+            if(BIORead() == 'q'){
+                FreqStop();
+                BIOOutCRLF();
+                BIOOutCRLF();
+                BIOPutStrg(InitialMessage);
+                BIOOutCRLF();
+                prg_state = COMMAND_PARSE;
+            } else {}
+            break;
+
+        /* If somehow the states are exited completely*/
+        default:
+            prg_state = COMMAND_PARSE;
+            break;
+        }
+        window = LoadPass(idle);
+    }
+}
+
+
+/**********************************************************************************
+* Command handlers
+**********************************************************************************/
+static INT8C CmdSoftware(const CMD_ARG *args, INT8U nargs){
+    return DispStart(CNT_SOFTWARE);
+}
+
+static INT8C CmdHardware(const CMD_ARG *args, INT8U nargs){
+    return DispStart(CNT_HARDWARE);
+}
+
+static INT8C CmdCombination(const CMD_ARG *args, INT8U nargs){
+    return DispStart(CNT_COMBINATION);
+}
+
+static INT8C CmdCompare(const CMD_ARG *args, INT8U nargs){
+    INT8U strat;
+    /* Compare counts from here on so earlier
+     * differences do not show up as divergence */
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        CmpBase[strat] = CntGet(strat);
+    }
+    BIOPutStrg(CompareHeader);
+    CompareOut();
+    return COMPARE_COUNTERS;
+}
+
+static INT8C CmdFilter(const CMD_ARG *args, INT8U nargs){
+    INT8U filt;
+    if(nargs > 0){
+        filt = CmdWordIndex(args[0].strg, FiltNames, CNT_NUM_FILT);
+        if(filt >= CNT_NUM_FILT){
+            BIOPutStrg("Unknown filter.");
             BIOOutCRLF();
+        } else if((nargs > 1) && ((args[1].num < 1U) || (args[1].num > PIN_FILT_MAX_WIDTH))){
+            BIOPutStrg("Width must be 1 to 31.");
             BIOOutCRLF();
+        } else {
+            if(nargs > 1){
+                FiltWidth[filt] = (INT8U)args[1].num;
+            } else {}
+            FiltSel = filt;
+            CntFilter(FiltSel, FiltWidth[FiltSel]);
+        }
+    } else {}
+    BIOPutStrg("SW2 filter: ");
+    BIOPutStrg(FiltNames[FiltSel]);
+    if(FiltWidth[FiltSel] != 0){
+        BIOPutStrg(" width ");
+        BIOOutDecWord(FiltWidth[FiltSel], 1U);
+    } else {}
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
 
-            /* Output user prompt and return to Command Parse */
-            BIOPutStrg(InitialMessage);
-            prg_state = COMMAND_PARSE;
+static INT8C CmdFiltExp(const CMD_ARG *args, INT8U nargs){
+    BIOPutStrg(FiltHeader);
+    FiltBase[0] = CntPresses();
+    FiltBase[1] = CntIsrEntries();
+    FiltRowOut();
+    DispLast = TS_GET();
+    return FILTER_EXPERIMENT;
+}
+
+static INT8C CmdHelpOut(const CMD_ARG *args, INT8U nargs){
+    CmdHelp(CmdTable, CMD_TABLE_LN);
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdInitBench(const CMD_ARG *args, INT8U nargs){
+    MemBenchInit();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdIsr(const CMD_ARG *args, INT8U nargs){
+    INT32U stamps[CNT_STAMPS];
+    INT8U nstamps;
+    INT8U i;
+    INT8U mode;
+    if(nargs > 0){
+        mode = CmdWordIndex(args[0].strg, IsrNames, CNT_NUM_ISR);
+        if(mode >= CNT_NUM_ISR){
+            BIOPutStrg("Unknown handler.");
+            BIOOutCRLF();
+        } else {
+            IsrSel = mode;
+            CntIsrMode(IsrSel);
+            QuantRestart();
+        }
+    } else {}
+    BIOPutStrg("SW2 handler: ");
+    BIOPutStrg(IsrNames[IsrSel]);
+    BIOOutCRLF();
+    if(IsrSel == CNT_ISR_STAMP){
+        /* Time between the last few edges */
+        nstamps = CntStamps(stamps);
+        for(i = 1; i < nstamps; i++){
+            BIOOutDecWord(TSCycToUs(stamps[i] - stamps[i - 1U]), 1U);
+            BIOPutStrg("us ");
+        }
+        BIOOutCRLF();
+    } else if(IsrSel == CNT_ISR_MULTI){
+        BIOPutStrg("Other PORTA edges: ");
+        BIOOutDecWord(CntOtherEdges(), 1U);
+        BIOOutCRLF();
+    } else {}
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdIsrBench(const CMD_ARG *args, INT8U nargs){
+    INT8U mode;
+    INT8U ram;
+    INT32U best;
+    INT32U worst;
+    BIOPutStrg("handler  from   best  worst  cycles, pend to return");
+    BIOOutCRLF();
+    for(mode = CNT_ISR_COUNT; mode < CNT_NUM_ISR; mode++){
+        for(ram = FALSE; ram <= TRUE; ram++){
+            best = CntIsrBench(mode, ram, &worst);
+            BIOPutStrg(IsrNames[mode]);
+            BIOPutStrg("    ");
+            BIOPutStrg((ram != FALSE) ? " ram  " : " flash");
+            BIOOutDecWord(best, 6U);
+            BIOWrite(' ');
+            BIOOutDecWord(worst, 6U);
+            BIOOutCRLF();
+        }
+    }
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdLoad(const CMD_ARG *args, INT8U nargs){
+    BIOPutStrg(LoadHeader);
+    LoadOut();
+    return CPU_LOAD;
+}
+
+static INT8C CmdLoops(const CMD_ARG *args, INT8U nargs){
+    LoopBase = LoopCnt;
+    LoopStart = TS_GET();
+    return LOOP_RATE;
+}
+
+static INT8C CmdMemBench(const CMD_ARG *args, INT8U nargs){
+    MemBenchCache();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdMemCfg(const CMD_ARG *args, INT8U nargs){
+    INT8U cfg;
+    if(nargs > 0){
+        if(args[0].num > MEMCFG_ALL){
+            BIOPutStrg("Bits must be 0 to 7.");
+            BIOOutCRLF();
+        } else {
+            MemCfgSet((INT8U)args[0].num);
+        }
+    } else {}
+    cfg = MemCfgGet();
+    BIOPutStrg("LMEM code cache: ");
+    BIOPutStrg(((cfg & MEMCFG_LMEM) != 0) ? "on" : "off");
+    BIOPutStrg("  FMC cache: ");
+    BIOPutStrg(((cfg & MEMCFG_FMC) != 0) ? "on" : "off");
+    BIOPutStrg("  Prefetch: ");
+    BIOPutStrg(((cfg & MEMCFG_PREFETCH) != 0) ? "on" : "off");
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdModerate(const CMD_ARG *args, INT8U nargs){
+    if(nargs > 0){
+        if(args[0].num > MOD_MAX_US){
+            BIOPutStrg("Holdoff must be 0 to 100000us.");
+            BIOOutCRLF();
+        } else {
+            ModUs = args[0].num;
+            CntModerate(ModUs);
+        }
+    } else {}
+    BIOPutStrg("Holdoff: ");
+    BIOOutDecWord(ModUs, 1U);
+    BIOPutStrg("us  ISR entries: ");
+    BIOOutDecWord(CntIsrEntries(), 1U);
+    BIOPutStrg("  DMA edges: ");
+    BIOOutDecWord(CntRecovered(), 1U);
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdBaud(const CMD_ARG *args, INT8U nargs){
+    BIOPutStrg("Switching to ");
+    BIOOutDecWord(args[0].num, 1U);
+    BIOPutStrg(" bps");
+    BIOOutCRLF();
+    if(BIOSetBaud(args[0].num) != 0){
+        BIOPutStrg("Rate not possible, not changed.");
+        BIOOutCRLF();
+    } else {}
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdBoot(const CMD_ARG *args, INT8U nargs){
+    BootProfOut();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdChkSum(const CMD_ARG *args, INT8U nargs){
+    INT8C state = COMMAND_PARSE;
+    if(args[0].num > args[1].num){
+        BIOPutStrg("Low address must not be above high address.");
+        BIOOutCRLF();
+    } else if((CsKernSel == CS_KERN_HW) && (ScanBusy() != FALSE)){
+        BIOPutStrg("CRC0 is busy with a scan.");
+        BIOOutCRLF();
+    } else {
+        state = CsRangeBegin(args[0].num, args[1].num);
+    }
+    return state;
+}
+
+static INT8C CmdCsAlg(const CMD_ARG *args, INT8U nargs){
+    INT8U alg = CsAlgSel;
+    INT8U kern = CS_KERN_SW;
+    INT8U bad = FALSE;
+    if(nargs > 0){
+        alg = CsAlgFind(args[0].strg);
+        if(nargs > 1){
+            kern = CmdWordIndex(args[1].strg, KernNames, CS_NUM_KERN);
+        } else {}
+        if(alg >= CS_NUM_ALG){
+            BIOPutStrg("Unknown algorithm.");
+            bad = TRUE;
+        } else if(CsHasKern(alg, kern) == FALSE){
+            BIOPutStrg("No such kernel for that algorithm.");
+            bad = TRUE;
+        } else {
+            CsAlgSel = alg;
+            CsKernSel = kern;
+        }
+        if(bad != FALSE){
+            BIOOutCRLF();
+        } else {}
+    } else {}
+    BIOPutStrg("Checksum: ");
+    BIOPutStrg(CsAlgName(CsAlgSel));
+    BIOWrite(' ');
+    BIOPutStrg(KernNames[CsKernSel]);
+    BIOPutStrg("  Available:");
+    for(alg = 0; alg < CS_NUM_ALG; alg++){
+        BIOWrite(' ');
+        BIOPutStrg(CsAlgName(alg));
+    }
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdCsClear(const CMD_ARG *args, INT8U nargs){
+    CsCacheClear();
+    BIOPutStrg("Boot checksum cache cleared.");
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdCsImage(const CMD_ARG *args, INT8U nargs){
+    INT32U low;
+    INT32U high;
+    INT8C state = COMMAND_PARSE;
+    if((CsKernSel == CS_KERN_HW) && (ScanBusy() != FALSE)){
+        BIOPutStrg("CRC0 is busy with a scan.");
+        BIOOutCRLF();
+    } else {
+        CsImageRange(&low, &high);
+        state = CsRangeBegin(low, high);
+    }
+    return state;
+}
+
+static INT8C CmdCsMode(const CMD_ARG *args, INT8U nargs){
+    INT8U mode;
+    if(nargs > 0){
+        mode = CmdWordIndex(args[0].strg, ModeNames, CS_NUM_MODE);
+        if(mode >= CS_NUM_MODE){
+            BIOPutStrg("Unknown mode.");
+            BIOOutCRLF();
+        } else {
+            CsModeSel = mode;
+        }
+    } else {}
+    BIOPutStrg("Checksum mode: ");
+    BIOPutStrg(ModeNames[CsModeSel]);
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdSelfTest(const CMD_ARG *args, INT8U nargs){
+    BIOPutStrg("Do not press SW2, this takes about 10 seconds.");
+    BIOOutCRLF();
+    SelfTestRun(IsrSel, ModUs);
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdStats(const CMD_ARG *args, INT8U nargs){
+    if(nargs > 0){
+        if(CmdWordIndex(args[0].strg, StatWords, 1U) == 0){
+            StatClear();
+        } else {
+            BIOPutStrg("Unknown option.");
+            BIOOutCRLF();
+        }
+    } else {}
+    BIOPutStrg("ms       n       mean        std        min        max        rms");
+    BIOOutCRLF();
+    StatRowOut("hold", STAT_HOLD);
+    StatRowOut("gap ", STAT_GAP);
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdFreq(const CMD_ARG *args, INT8U nargs){
+    INT8C state = COMMAND_PARSE;
+    INT32U gate = FREQ_GATE_DEF_MS;
+    if(nargs > 0){
+        gate = args[0].num;
+    } else {}
+    if((gate < FREQ_GATE_MIN_MS) || (gate > FREQ_GATE_MAX_MS)){
+        BIOPutStrg("Gate is 10 to 10000 ms.");
+        BIOOutCRLF();
+    } else {
+        BIOPutStrg("Pulses on PTC5, q to stop. Gate ");
+        BIOOutDecWord(gate, 1U);
+        BIOPutStrg("ms");
+        BIOOutCRLF();
+        FreqStart(gate);
+        state = FREQ_METER;
+    }
+    return state;
+}
+
+static INT8C CmdQuant(const CMD_ARG *args, INT8U nargs){
+    INT32U missed;
+    if(nargs > 0){
+        switch(CmdWordIndex(args[0].strg, QuantWords, 2U)){
+        case(0U):                       /* lat */
+            BIOPutStrg("Do not press SW2.");
+            BIOOutCRLF();
+            missed = QuantLatency();
+            if(missed != 0){
+                BIOOutDecWord(missed, 1U);
+                BIOPutStrg(" edges timed out, turn the filter off");
+                BIOOutCRLF();
+            } else {}
             break;
+        case(1U):                       /* clear */
+            QuantClear();
+            break;
+        default:
+            BIOPutStrg("Unknown option.");
+            BIOOutCRLF();
+            break;
+        }
+    } else {}
+    BIOPutStrg("us          n        p50        p90        p99      p99.9");
+    BIOOutCRLF();
+    QuantRowOut("edge", QUANT_EDGE);
+    QuantRowOut("lat ", QUANT_LAT);
+    BIOPutStrg("Edges lost to the stamp ring: ");
+    BIOOutDecWord(QuantLost(), 1U);
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
 
-        /* If somehow the four states are exited completely*/
+static INT8C CmdHist(const CMD_ARG *args, INT8U nargs){
+    INT8C state = COMMAND_PARSE;
+    INT32U secs;
+    INT32U covered;
+    INT64U total;
+    if(nargs == 0){
+        HistInfoOut();
+    } else {
+        HistFrom = 0;
+        HistTo = 0xFFFFFFFFU;
+        HistLines = 0;
+        switch(CmdWordIndex(args[0].strg, HistWords, 4U)){
+        case(0U):                       /* counts <s> */
+            secs = (nargs > 1U) ? args[1].num : 60U;
+            total = HistCounts(secs, &covered);
+            BIOOutDecWord((INT32U)total, 1U);
+            BIOPutStrg(" counts in the last ");
+            BIOOutDecWord(covered, 1U);
+            BIOPutStrg("s");
+            BIOOutCRLF();
+            break;
+        case(1U):                       /* events <from> <to> */
+            if(nargs > 1U){
+                HistFrom = args[1].num;
+            } else {}
+            if(nargs > 2U){
+                HistTo = args[2].num;
+            } else {}
+            HistBoth = FALSE;
+            HistIterStart(HIST_EVENTS, &HistIt);
+            state = HIST_EXPORT;
+            break;
+        case(2U):                       /* export */
+            HistBoth = TRUE;
+            HistIterStart(HIST_COUNTS, &HistIt);
+            state = HIST_EXPORT;
+            break;
+        case(3U):                       /* clear */
+            HistClear();
+            break;
         default:
-            prg_state = COMMAND_PARSE;
+            BIOPutStrg("Unknown option.");
+            BIOOutCRLF();
             break;
         }
     }
+    return state;
+}
+
+static INT8C CmdScan(const CMD_ARG *args, INT8U nargs){
+    if(ScanBusy() != FALSE){
+        BIOPutStrg("Scan already running.");
+    } else {
+        PersistWait();
+        BIOPutStrg("Scanning ");
+        BIOOutDecWord(ScanStart(), 1U);
+        BIOPutStrg(" regions");
+    }
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdCsBench(const CMD_ARG *args, INT8U nargs){
+    if(ScanBusy() != FALSE){
+        BIOPutStrg("CRC0 is busy with a scan.");
+        BIOOutCRLF();
+    } else {
+        CsBench();
+    }
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdPersist(const CMD_ARG *args, INT8U nargs){
+    PERSIST_INFO info;
+    if(nargs > 0){
+        if(CmdWordIndex(args[0].strg, PersistWords, 1U) == 0U){
+            PersistSave();
+            BIOPutStrg("Checkpoint due.");
+        } else {
+            BIOPutStrg("Unknown option.");
+        }
+        BIOOutCRLF();
+    } else {}
+    PersistInfo(&info);
+    if(info.off != FALSE){
+        BIOPutStrg("Log not used, the image reaches ");
+        BIOOutHexWord(PERSIST_BASE);
+        BIOOutCRLF();
+    } else {}
+    BIOPutStrg((info.restored != FALSE) ? "Counts restored at boot, " : "No record at boot, ");
+    BIOPutStrg("log scanned in ");
+    BIOOutDecWord(TSCycToUs(info.boot_cyc), 1U);
+    BIOPutStrg(" us");
+    BIOOutCRLF();
+    BIOPutStrg("Checkpoints: ");
+    BIOOutDecWord(info.saves, 1U);
+    BIOPutStrg("  erases: ");
+    BIOOutDecWord(info.erases, 1U);
+    BIOPutStrg("  errors: ");
+    BIOOutDecWord(info.errors, 1U);
+    BIOOutCRLF();
+    BIOPutStrg("Latency us: last ");
+    BIOOutDecWord(TSCycToUs(info.last_cyc), 1U);
+    BIOPutStrg("  max ");
+    BIOOutDecWord(TSCycToUs(info.max_cyc), 1U);
+    BIOOutCRLF();
+    BIOPutStrg("Next record at ");
+    BIOOutHexWord(info.next);
+    if(info.busy != FALSE){
+        BIOPutStrg(", writing");
+    } else if(info.held != FALSE){
+        BIOPutStrg(", held until the clock leaves HSRUN");
+    } else {}
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdRate(const CMD_ARG *args, INT8U nargs){
+    DispRate = args[0].num;
+    DispPeriod = TSHzToCyc(DispRate);
+    return COMMAND_PARSE;
+}
+
+static INT8C CmdClock(const CMD_ARG *args, INT8U nargs){
+    INT8U profile;
+    INT8U bad_rate = FALSE;
+    if(nargs > 0){
+        profile = CmdWordIndex(args[0].strg, ClkNames, K65TWR_CLK_NUM);
+        if(profile >= K65TWR_CLK_NUM){
+            BIOPutStrg("Unknown clock profile.");
+            BIOOutCRLF();
+        } else {
+            /* Nothing may be sending while the UART clock changes */
+            BIOFlush();
+            PersistWait();
+            (void)K65TWR_SetClock(profile);
+            bad_rate = BIOSetClk(K65TWR_BusClock());
+            DispPeriod = TSHzToCyc(DispRate);
+        }
+    } else {}
+    if(bad_rate != FALSE){
+        BIOPutStrg("Bit rate not possible at this clock, now 9600 bps.");
+        BIOOutCRLF();
+    } else {}
+    BIOPutStrg("Clock: ");
+    if(K65TWR_GetClock() < K65TWR_CLK_NUM){
+        BIOPutStrg(ClkNames[K65TWR_GetClock()]);
+    } else {
+        BIOPutStrg("?");
+    }
+    BIOPutStrg("  Core: ");
+    BIOOutDecWord(SystemCoreClock, 1U);
+    BIOPutStrg(" Hz  Bus: ");
+    BIOOutDecWord(K65TWR_BusClock(), 1U);
+    BIOPutStrg(" Hz");
+    BIOOutCRLF();
+    return COMMAND_PARSE;
+}
+
+
+/**********************************************************************************
+* DispStart()
+*
+* Description:  Selects the counter shown by the counter display states and
+*               outputs its accumulated total
+*
+* Return Value: the counter display state for strat
+*
+* Arguments:    strat is the counter to display
+**********************************************************************************/
+static INT8C DispStart(INT8U strat){
+    INT8C state;
+    DispStrat = strat;
+    if(strat == CNT_SOFTWARE){
+        state = SOFTWARE_COUNTER;
+    } else if(strat == CNT_HARDWARE){
+        state = HARDWARE_COUNTER;
+    } else {
+        state = COMBINATION_COUNTER;
+    }
+    /* Begin Outputting Counter from its accumulated total */
+    DispCnt = CntGet(DispStrat);
+    DispOut();
+    DispLast = TS_GET();
+    return state;
+}
+
+
+/**********************************************************************************
+* DispOut()
+*
+* Description:  Outputs the displayed count followed by its rate over the
+*               sliding window and its moving average, in events per second
+*               with one decimal. Ends with '\r' so the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void DispOut(void){
+    BIOOutDecWord(DispCnt, LEADING_ZEROS);
+    BIOPutStrg("  win ");
+    RateOut(RateWindow(DispStrat));
+    BIOPutStrg("/s  avg ");
+    RateOut(RateEwma(DispStrat));
+    BIOPutStrg("/s    \r");
+}
+
+
+/**********************************************************************************
+* RateOut()
+*
+* Description:  Outputs a rate in tenths as a number with one decimal
+*
+* Return Value: none
+*
+* Arguments:    tenths is the rate in tenths of an event per second
+**********************************************************************************/
+static void RateOut(INT32U tenths){
+    BIOOutDecWord(tenths / 10U, 1U);
+    BIOWrite('.');
+    BIOOutDecWord(tenths % 10U, 1U);
+}
+
+
+/**********************************************************************************
+* HistRowOut()
+*
+* Description:  Outputs one history entry as a line of comma separated
+*               values: c,<second>,<count> for a counts interval that is not
+*               zero or e,<seconds with six decimals> for a press. Entries
+*               outside the selected seconds are left out. Counts the lines.
+*
+* Return Value: none
+*
+* Arguments:    sec and val are the entry as read by HistNext()
+**********************************************************************************/
+static void HistRowOut(INT32U sec, INT64U val){
+    if((sec >= HistFrom) && (sec <= HistTo)){
+        if(HistIt.ser == HIST_COUNTS){
+            if(val != 0){
+                BIOPutStrg("c,");
+                BIOOutDecWord(sec, 1U);
+                BIOWrite(',');
+                BIOOutDecWord((INT32U)val, 1U);
+                BIOOutCRLF();
+                HistLines++;
+            } else {}
+        } else {
+            BIOPutStrg("e,");
+            BIOOutDecWord(sec, 1U);
+            BIOWrite('.');
+            BIOOutDecWord((INT32U)(val % 1000000U), 6U);
+            BIOOutCRLF();
+            HistLines++;
+        }
+    } else {}
+}
+
+
+/**********************************************************************************
+* QuantRowOut()
+*
+* Description:  Outputs one line of the quant table: the sketch name, its
+*               number of samples and its p50, p90, p99 and p99.9 in
+*               microseconds with three decimals
+*
+* Return Value: none
+*
+* Arguments:    name is the sketch name, sk is QUANT_EDGE or QUANT_LAT
+**********************************************************************************/
+static void QuantRowOut(const INT8C *name, INT8U sk){
+    INT8U i;
+    INT64U ns;
+    BIOPutStrg(name);
+    BIOWrite(' ');
+    BIOOutDecWord(QuantCount(sk), 8U);
+    for(i = 0; i < 4U; i++){
+        ns = ((INT64U)QuantGet(sk, QuantPcts[i]) * 1000000000U) / SystemCoreClock;
+        BIOWrite(' ');
+        BIOOutDecWord((INT32U)(ns / 1000U), 6U);
+        BIOWrite('.');
+        BIOOutDecWord((INT32U)(ns % 1000U), 3U);
+    }
+    BIOOutCRLF();
+}
+
+
+/**********************************************************************************
+* FreqOut()
+*
+* Description:  Outputs a frequency meter result: Hz with three decimals, the
+*               measurement method and the edges it is based on. Ends with
+*               '\r' so the next result overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    res is the result from FreqGet()
+**********************************************************************************/
+static void FreqOut(const FREQ_RESULT *res){
+    BIOOutDecWord(res->hz, 8U);
+    BIOWrite('.');
+    BIOOutDecWord(res->milli, 3U);
+    if(res->recip != FALSE){
+        BIOPutStrg(" Hz  period ");
+    } else {
+        BIOPutStrg(" Hz  gated  ");
+    }
+    BIOOutDecWord(res->edges, 1U);
+    BIOPutStrg(" edges     \r");
+}
+
+
+/**********************************************************************************
+* HistInfoOut()
+*
+* Description:  Outputs the blocks, entries and encoded bytes held by each
+*               history series and the seconds they span
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void HistInfoOut(void){
+    HIST_INFO info;
+    INT8U ser;
+    BIOPutStrg("series  blocks  entries    bytes  from s    to s");
+    BIOOutCRLF();
+    for(ser = 0; ser < HIST_NUM_SER; ser++){
+        HistInfo(ser, &info);
+        BIOPutStrg((ser == HIST_COUNTS) ? "counts  " : "events  ");
+        BIOOutDecWord(info.blocks, 6U);
+        BIOPutStrg("  ");
+        BIOOutDecWord(info.entries, 7U);
+        BIOPutStrg("  ");
+        BIOOutDecWord(info.bytes, 7U);
+        BIOPutStrg("  ");
+        BIOOutDecWord(info.first, 6U);
+        BIOPutStrg("  ");
+        BIOOutDecWord(info.last, 6U);
+        BIOOutCRLF();
+    }
+}
+
+
+/**********************************************************************************
+* DispDue()
+*
+* Description:  Limits display refreshes to the rate set by the rate command
+*
+* Return Value: TRUE if the display may be refreshed now
+*
+* Arguments:    none
+**********************************************************************************/
+static INT8U DispDue(void){
+    INT8U due;
+    INT32U now = TS_GET();
+    if((DispPeriod == 0) || ((now - DispLast) >= DispPeriod)){
+        DispLast = now;
+        due = TRUE;
+    } else {
+        due = FALSE;
+    }
+    return due;
+}
+
+
+/**********************************************************************************
+* OutChkSum()
+*
+* Description:  Outputs the checksum of a memory block in the form
+*               CS : LLLLLLLL-HHHHHHHH XXXX where LLLLLLLL is the low address,
+*               HHHHHHHH is the high address and XXXX is the check sum.
+*               Does not end the line.
+*
+* Return Value: none
+*
+* Arguments:    lowaddr and highaddr are the first and last address of the block
+*               sum is the check sum, digits is 4 or 8 hex digits
+**********************************************************************************/
+static void OutChkSum(INT32U lowaddr, INT32U highaddr, INT32U sum, INT8U digits){
+    BIOPutStrg("CS : ");
+    BIOOutHexWord(lowaddr);
+    BIOPutStrg("-");
+    BIOOutHexWord(highaddr);
+    BIOPutStrg(" ");
+    if(digits > 4U){
+        BIOOutHexWord(sum);
+    } else {
+        BIOOutHexHWord((INT16U)sum);
+    }
+}
+
+
+/**********************************************************************************
+* BootChkSum()
+*
+* Description:  Outputs the boot checksum. A value cached by this build on an
+*               earlier boot is shown right away and rescanned in the background
+*               by BootChkSumTask(), otherwise the block is scanned now and the
+*               result cached. A mismatch latched by an earlier rescan is
+*               reported first, on every boot until csclear.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void BootChkSum(void){
+    INT16U sum;
+#if BOOT_CS_IMAGE
+    CsImageRange(&BootCsLow, &BootCsHigh);
+#else
+    BootCsLow = ZERO_ADDR;
+    BootCsHigh = HIGH_ADDR;
+#endif
+    if(CsCacheAlert(&sum) != FALSE){
+        /* Latched by an earlier rescan, repeated on every boot until csclear */
+        BIOPutStrg(CsAlertMessage);
+        OutChkSum(BootCsLow, BootCsHigh, sum, 4U);
+        BIOPutStrg(" (expected, csclear to accept the new value)");
+        BIOOutCRLF();
+    } else {}
+    if(CsCacheGet(BootCsLow, BootCsHigh, &sum) != FALSE){
+        OutChkSum(BootCsLow, BootCsHigh, sum, 4U);
+        BIOPutStrg(" (cached, verifying)");
+        CsVerifyStart(BootCsLow, BootCsHigh, sum);
+    } else {
+#if BOOT_CS_SKIP
+        sum = (INT16U)CsCalcSkip(CS_ALG_SUM16, CS_KERN_SW, BootCsLow, BootCsHigh);
+#else
+        sum = CalcChkSum((INT8U *)BootCsLow, (INT8U *)BootCsHigh);
+#endif
+        OutChkSum(BootCsLow, BootCsHigh, sum, 4U);
+        CsCachePut(BootCsLow, BootCsHigh, sum);
+    }
+    BIOOutCRLF();
+}
+
+
+/**********************************************************************************
+* CsRangeBegin()
+*
+* Description:  Starts checksumming a memory block with the algorithm, kernel
+*               and mode selected by the csalg and csmode commands. The block is
+*               handled CS_RANGE_STEP bytes per main loop pass in the
+*               CHKSUM_RANGE state, which outputs the result.
+*
+* Return Value: the next program state
+*
+* Arguments:    lowaddr and highaddr are the first and last address of the block
+**********************************************************************************/
+static INT8C CsRangeBegin(INT32U lowaddr, INT32U highaddr){
+    PersistWait();
+    CsRangeSel.low = lowaddr;
+    CsRangeSel.high = highaddr;
+    CsRangeSel.cycles = 0;
+    CsRangeSel.last = TS_GET();
+    CsRangeStart(&CsRangeSel.rng, CsAlgSel, CsKernSel, lowaddr, highaddr,
+                 (CsModeSel == CS_MODE_SKIP) ? TRUE : FALSE);
+    return CHKSUM_RANGE;
+}
+
+
+/**********************************************************************************
+* CsRangeOut()
+*
+* Description:  Outputs the CS line for the finished cs block followed by the
+*               elapsed milliseconds, the bytes per second and, in skip mode,
+*               the number of erased bytes skipped.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void CsRangeOut(void){
+    INT64U bytes = ((INT64U)CsRangeSel.high - CsRangeSel.low) + 1U;
+    INT64U bps = 0;
+    if(CsRangeSel.cycles != 0){
+        bps = (bytes * SystemCoreClock) / CsRangeSel.cycles;
+    } else {}
+    OutChkSum(CsRangeSel.low, CsRangeSel.high, CsFinish(&CsRangeSel.rng.ctx),
+              CsAlgDigits(CsAlgSel));
+    BIOPutStrg("  ");
+    BIOOutDecWord((INT32U)((CsRangeSel.cycles * 1000U) / SystemCoreClock), 1U);
+    BIOPutStrg(" ms  ");
+    BIOOutDecWord((INT32U)bps, 1U);
+    BIOPutStrg(" B/s");
+    if(CsRangeSel.rng.skip != FALSE){
+        BIOPutStrg("  skipped ");
+        BIOOutDecWord(CsRangeSel.rng.skipped, 1U);
+    } else {}
+    BIOOutCRLF();
+}
+
+
+/**********************************************************************************
+* BootChkSumTask()
+*
+* Description:  Runs the background rescan of a cached boot checksum. Sounds an
+*               alert if the memory no longer matches the cached value.
+*               Call once per main loop pass.
+*
+* Return Value: TRUE while the rescan is running
+*
+* Arguments:    none
+**********************************************************************************/
+static INT8U BootChkSumTask(void){
+    INT16U sum;
+    INT8U state;
+    state = CsVerifyTask(&sum);
+    if(state == CS_VERIFY_FAIL){
+        BIOOutCRLF();
+        BIOPutStrg(CsAlertMessage);
+        OutChkSum(BootCsLow, BootCsHigh, sum, 4U);
+        BIOPutStrg(" (scanned)");
+        BIOOutCRLF();
+        BIOPutStrg(CsAlertMessage);
+        BIOOutCRLF();
+    } else {}
+    return (INT8U)(state == CS_VERIFY_BUSY);
 }
 
 
 /**********************************************************************************
-* PORTA-IRQHandler()
+* ScanOut()
 *
-* Description:  clears ISF for SW2 immediately then updates
-*               global variable Sw_Cnt_Globe so that counter display
-*               for hardware counter can be incremented
+* Description:  Outputs a line for each region the integrity scanner finishes,
+*               the CS line followed by the region name, algorithm and cycles.
+*               Call once per main loop pass.
 *
 * Return Value: none
 *
 * Arguments:    none
 **********************************************************************************/
-void PORTA_IRQHandler(void){
-    SW2_CLR_ISF();
-    Sw_Cnt_Globe++;
+static void ScanOut(void){
+    SCAN_RESULT res;
+    if(ScanTask(&res) != FALSE){
+        OutChkSum(res.low, res.high, res.sum, CsAlgDigits(res.alg));
+        BIOWrite(' ');
+        BIOPutStrg(res.name);
+        BIOWrite(' ');
+        BIOPutStrg(CsAlgName(res.alg));
+        BIOWrite(' ');
+        BIOOutDecWord(res.cycles, 1U);
+        BIOPutStrg(" cyc");
+        if(res.err != FALSE){
+            BIOPutStrg(" DMA ERROR");
+        } else {}
+        BIOOutCRLF();
+    } else {}
 }
 
 
 /**********************************************************************************
-* GPIOAPeriphIni()
+* FiltRowOut()
 *
-* Description:  Initializes PORTA Peripheral as specified by user
+* Description:  Outputs the filter experiment line for the active filter: the
+*               filter, its width, the debounced presses, the ISR entries and
+*               the ISR entries that were not presses, all counted since the
+*               filter was selected. Ends with '\r' so the next line
+*               overwrites it.
 *
 * Return Value: none
 *
-* Arguments:    INT8U pin_num,   The PCR number of the Peripheral
-*               INT8U irq_code,  The interrupt request code
-*               INT8U mux,       The Pin Mux Control code
+* Arguments:    none
+**********************************************************************************/
+static void FiltRowOut(void){
+    INT32U presses;
+    INT32U isr;
+    INT8U col;
+
+    FiltLast[0] = CntPresses();
+    FiltLast[1] = CntIsrEntries();
+    presses = FiltLast[0] - FiltBase[0];
+    isr = FiltLast[1] - FiltBase[1];
+    BIOPutStrg(FiltNames[FiltSel]);
+    col = 0;
+    while(FiltNames[FiltSel][col] != '\0'){
+        col++;
+    }
+    while(col < 8U){
+        BIOWrite(' ');
+        col++;
+    }
+    BIOOutDecWord(FiltWidth[FiltSel], 5U);
+    BIOWrite(' ');
+    BIOOutDecWord(presses, 10U);
+    BIOWrite(' ');
+    BIOOutDecWord(isr, 10U);
+    BIOWrite(' ');
+    /* A filter that is too wide can also swallow real presses */
+    if(isr >= presses){
+        BIOWrite(' ');
+        BIOOutDecWord(isr - presses, 10U);
+    } else {
+        BIOWrite('-');
+        BIOOutDecWord(presses - isr, 10U);
+    }
+    BIOWrite('\r');
+}
+
+
+/**********************************************************************************
+* LoadOut()
+*
+* Description:  Outputs the CPU load line for the last one second window, the
+*               share of each category and the total of all but idle. Ends
+*               with '\r' so the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
 **********************************************************************************/
-static void GPIOAPeriphIni(INT8U pin_num, INT8U mux_code, INT8U irq_code){
-    SIM->SCGC5 |= SIM_SCGC5_PORTA_MASK;
-    PORTA->PCR[pin_num] = PORT_PCR_MUX(mux_code)|PORT_PCR_IRQC(irq_code);
+static void LoadOut(void){
+    INT8U cat;
+    INT16U share;
+    for(cat = 0; cat <= LOAD_NUM_CAT; cat++){
+        if(cat < LOAD_NUM_CAT){
+            share = LoadGet(cat);
+        } else {
+            share = (INT16U)(1000U - LoadGet(LOAD_IDLE));
+        }
+        BIOOutDecWord(share / 10U, 3U);
+        BIOWrite('.');
+        BIOOutDecWord(share % 10U, 1U);
+        BIOWrite(' ');
+    }
+    BIOWrite('\r');
 }
 
 
 /**********************************************************************************
-* CalcChkSum() -ascertains checksum for memory block indicated by starting and
-*               ending addresses
+* StatRowOut()
 *
-* Description:  Loads every byte from starting address to ending address
-*               and takes the first 16 bits of the sum of all said bytes.
-*               Note that it if starting address is greater than ending address
-*               function will only return byte stored at ending address.
+* Description:  Outputs one line of the stats table: the series name, the
+*               number of samples and mean, std dev, min, max and RMS in
+*               milliseconds with three decimals.
 *
-* Return Value: c_sum, 16 bit unsigned integer, the first 16 bits of the sum
-*               of all bytes between the two addresses
+* Return Value: none
 *
-* Arguments:    startaddr is pointer to the initial address of the memory block
-*               endaddr is the pointer to the last address of the memory block
+* Arguments:    name is the series name, ser is STAT_HOLD or STAT_GAP
 **********************************************************************************/
-static INT16U CalcChkSum(INT8U *startaddr, INT8U *endaddr){
-    INT16U c_sum = 0;
-    INT8U membyte;
-    INT8U *addr = startaddr;
+static void StatRowOut(const INT8C *name, INT8U ser){
+    STAT_RESULT res;
+    FP32 val[5];
+    INT32U us;
+    INT8U i;
 
-    /*Iterate over all memory locations from start address to address
-     * right before ending address and sum up all bytes*/
-    while(addr < endaddr){
-        membyte = *addr;
-        addr++;
-        c_sum += (INT16U)membyte;
+    StatCalc(ser, &res);
+    val[0] = res.mean;
+    val[1] = res.std;
+    val[2] = res.min;
+    val[3] = res.max;
+    val[4] = res.rms;
+    BIOPutStrg(name);
+    BIOWrite(' ');
+    BIOOutDecWord(res.n, 4U);
+    for(i = 0; i < 5U; i++){
+        us = (INT32U)(val[i] + 0.5f);
+        BIOWrite(' ');
+        BIOOutDecWord(us / 1000U, 5U);
+        BIOWrite('.');
+        BIOOutDecWord(us % 1000U, 3U);
     }
-    c_sum += ( (INT16U)(*endaddr) );
+    BIOOutCRLF();
+}
+
 
-    return c_sum;
+/**********************************************************************************
+* CompareOut()
+*
+* Description:  Outputs one comparison line with the count each strategy has
+*               accumulated since CmpBase was taken and the divergence, the
+*               largest count minus the smallest count. Ends with '\r' so
+*               the next line overwrites it.
+*
+* Return Value: none
+*
+* Arguments:    none
+**********************************************************************************/
+static void CompareOut(void){
+    INT8U strat;
+    INT32U delta;
+    INT32U maxcnt = 0;
+    INT32U mincnt = 0xFFFFFFFFU;
+
+    for(strat = 0; strat < CNT_NUM_STRAT; strat++){
+        CmpLast[strat] = CntGet(strat);
+        delta = CmpLast[strat] - CmpBase[strat];
+        if(delta > maxcnt){
+            maxcnt = delta;
+        } else {}
+        if(delta < mincnt){
+            mincnt = delta;
+        } else {}
+        BIOOutDecWord(delta, 10U);
+        BIOWrite(' ');
+    }
+    BIOOutDecWord(maxcnt - mincnt, 10U);
+    BIOWrite('\r');
 }
 
 
@@ -58,6 +58,13 @@ extern "C" {
 #endif
 #endif
 
+//*****************************************************************************
+// Boot phase profiler. BootProfStart() and BootProfMark() use no initialized
+// data so they can run before data_init() and bss_init().
+//*****************************************************************************
+#include "MCUType.h"
+#include "BootProf.h"
+
 #define WEAK __attribute__ ((weak))
 #define WEAK_AV __attribute__ ((weak, section(".after_vectors")))
 #define ALIAS(f) __attribute__ ((weak, alias (#f)))
@@ -470,21 +477,50 @@ void (* const g_pfnVectors[])(void) = {
 // are written as separate functions rather than being inlined within the
 // ResetISR() function in order to cope with MCUs with multiple banks of
 // memory.
+// The bulk of each section is moved 32 bytes at a time with LDM/STM bursts,
+// which take one bus cycle per word after the first instead of a separate
+// load, store and loop test per word. Any tail shorter than a burst is done a
+// word at a time. len is rounded up to whole words, like the original loops.
 //*****************************************************************************
+#define INIT_BURST_BYTES 32U
+
 __attribute__ ((section(".after_vectors.init_data")))
 void data_init(unsigned int romstart, unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
 	unsigned int *pulSrc = (unsigned int*) romstart;
+	unsigned int *pulBurstEnd = pulDest + ((len / INIT_BURST_BYTES) * (INIT_BURST_BYTES / 4U));
 	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	while (pulDest < pulBurstEnd) {
+		__asm volatile ("ldmia %0!, {r3, r4, r5, r6, r8, r9, r10, r12}\n\t"
+		                "stmia %1!, {r3, r4, r5, r6, r8, r9, r10, r12}"
+		                : "+r" (pulSrc), "+r" (pulDest)
+		                :
+		                : "r3", "r4", "r5", "r6", "r8", "r9", "r10", "r12", "memory");
+	}
+	for (loop = len % INIT_BURST_BYTES; loop > 0; loop = (loop > 4U) ? (loop - 4U) : 0U)
 		*pulDest++ = *pulSrc++;
 }
 
 __attribute__ ((section(".after_vectors.init_bss")))
 void bss_init(unsigned int start, unsigned int len) {
 	unsigned int *pulDest = (unsigned int*) start;
+	unsigned int *pulBurstEnd = pulDest + ((len / INIT_BURST_BYTES) * (INIT_BURST_BYTES / 4U));
 	unsigned int loop;
-	for (loop = 0; loop < len; loop = loop + 4)
+	__asm volatile ("movs r3, #0\n\t"
+	                "movs r4, #0\n\t"
+	                "movs r5, #0\n\t"
+	                "movs r6, #0\n\t"
+	                "1:\n\t"
+	                "cmp %0, %1\n\t"
+	                "bhs 2f\n\t"
+	                "stmia %0!, {r3, r4, r5, r6}\n\t"
+	                "stmia %0!, {r3, r4, r5, r6}\n\t"
+	                "b 1b\n\t"
+	                "2:"
+	                : "+r" (pulDest)
+	                : "r" (pulBurstEnd)
+	                : "r3", "r4", "r5", "r6", "cc", "memory");
+	for (loop = len % INIT_BURST_BYTES; loop > 0; loop = (loop > 4U) ? (loop - 4U) : 0U)
 		*pulDest++ = 0;
 }
 
@@ -512,9 +548,13 @@ void ResetISR(void) {
     // Disable interrupts
     __asm volatile ("cpsid i");
 
+    // Start the boot profile clock
+    BootProfStart();
+
 #if defined (__USE_CMSIS)
 // If __USE_CMSIS defined, then call CMSIS SystemInit code
     SystemInit();
+    BootProfMark(BP_SYSINIT);
 
 #else
     // Disable Watchdog
@@ -535,13 +575,16 @@ void ResetISR(void) {
 	// Load base address of Global Section Table
 	SectionTableAddr = &__data_section_table;
 
-    // Copy the data sections from flash to SRAM.
+    // Copy the data sections from flash to SRAM. The managed linker script
+    // has an entry per RAM bank, so the SRAM_L entry also brings the
+    // .ramfunc.$SRAM_LOWER code (see RamFunc.h) over before anything calls it.
 	while (SectionTableAddr < &__data_section_table_end) {
 		LoadAddr = *SectionTableAddr++;
 		ExeAddr = *SectionTableAddr++;
 		SectionLen = *SectionTableAddr++;
 		data_init(LoadAddr, ExeAddr, SectionLen);
 	}
+	BootProfMark(BP_DATA);
 
 	// At this point, SectionTableAddr = &__bss_section_table;
 	// Zero fill the bss segment
@@ -550,6 +593,7 @@ void ResetISR(void) {
 		SectionLen = *SectionTableAddr++;
 		bss_init(ExeAddr, SectionLen);
 	}
+	BootProfMark(BP_BSS);
 
 #if !defined (__USE_CMSIS)
 // Assume that if __USE_CMSIS defined, then CMSIS SystemInit code
@@ -0,0 +1,952 @@
+/****************************************************************************************
+* cschk.c - Host side firmware image checksum for rsLab3Project.
+*
+*   Predicts the "CS :" line the board prints at boot. The image is a raw .bin,
+*   a Motorola .srec or an Intel .hex file. It is memory mapped, loaded into a
+*   buffer covering the checksum range that starts out erased (0xFF), and
+*   checksummed with the same algorithms as source/ChkSum.c:
+*
+*     sum16       low 16 bits of the byte sum, the boot checksum
+*     fletcher32  little endian 16-bit words, odd byte zero padded
+*     adler32
+*     crc16       CRC-16/CCITT-FALSE, 0x1021 init 0xFFFF
+*     crc32       CRC-32 as used by zip and ethernet
+*
+*   The sums have AVX2 and SSE4.1 kernels picked at run time from what the CPU
+*   supports, with a scalar fallback. The CRCs are table driven on every
+*   kernel, CRC-32 eight bytes at a time. --selftest compares every kernel
+*   against a byte at a time reference taken from the firmware code.
+*
+*   Build:  gcc -O2 -Wall -o cschk tools/cschk.c
+*   Usage:  cschk [-a alg|all] [-k scalar|sse|avx2] [-f bin|srec|hex]
+*                 [-b base] [-l low] [-h high] [-v] image
+*           cschk --selftest
+*
+*   Addresses are hex. -b is the load address of a .bin file, default 0.
+*   -l and -h default to 0 and 1FBFFF, the range the board checks at boot. The
+*   counter log above it changes at run time.
+*
+****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <strings.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <immintrin.h>
+
+#define CS_LOW_DEF          0x00000000U
+#define CS_HIGH_DEF         0x001FBFFFU
+#define CS_ERASED           0xFFU
+
+#define FLETCHER_MOD        65535U
+#define ADLER_MOD           65521U
+#define ADLER_BYTES         5552U           /* Bytes before the scalar sums can overflow */
+#define FLETCHER_WORDS      359U            /* Words before the scalar sums can overflow */
+#define SIMD_CHUNK          4096U           /* Bytes per vector pass before lanes can overflow */
+#define ADLER_SIMD_CHUNK    5536U           /* Largest multiple of 32 not above ADLER_BYTES */
+
+#define CRC16_POLY          0x1021U
+#define CRC16_INIT          0xFFFFU
+#define CRC32_POLY          0xEDB88320U
+#define CRC32_INIT          0xFFFFFFFFU
+
+#define ALG_SUM16           0
+#define ALG_FLETCHER32      1
+#define ALG_ADLER32         2
+#define ALG_CRC16           3
+#define ALG_CRC32           4
+#define NUM_ALG             5
+
+#define KERN_SCALAR         0
+#define KERN_SSE            1
+#define KERN_AVX2           2
+#define NUM_KERN            3
+
+#define FMT_BIN             0
+#define FMT_SREC            1
+#define FMT_HEX             2
+
+typedef uint32_t (*CS_FUNC)(const uint8_t *data, size_t len);
+
+typedef struct{
+    const char *name;
+    int digits;
+    CS_FUNC kern[NUM_KERN];
+}ALG;
+
+/****************************************************************************************
+* Private Resources
+****************************************************************************************/
+static uint32_t refSum16(const uint8_t *d, size_t n);
+static uint32_t refFletcher32(const uint8_t *d, size_t n);
+static uint32_t refAdler32(const uint8_t *d, size_t n);
+static uint32_t refCrc16(const uint8_t *d, size_t n);
+static uint32_t refCrc32(const uint8_t *d, size_t n);
+
+static uint32_t scalarSum16(const uint8_t *d, size_t n);
+static uint32_t scalarFletcher32(const uint8_t *d, size_t n);
+static uint32_t scalarAdler32(const uint8_t *d, size_t n);
+static uint32_t tblCrc16(const uint8_t *d, size_t n);
+static uint32_t tblCrc32(const uint8_t *d, size_t n);
+
+static uint32_t sseSum16(const uint8_t *d, size_t n);
+static uint32_t sseFletcher32(const uint8_t *d, size_t n);
+static uint32_t sseAdler32(const uint8_t *d, size_t n);
+static uint32_t avxSum16(const uint8_t *d, size_t n);
+static uint32_t avxFletcher32(const uint8_t *d, size_t n);
+static uint32_t avxAdler32(const uint8_t *d, size_t n);
+
+static const ALG algTbl[NUM_ALG] = {
+    {"sum16",      4, {scalarSum16,      sseSum16,      avxSum16}},
+    {"fletcher32", 8, {scalarFletcher32, sseFletcher32, avxFletcher32}},
+    {"adler32",    8, {scalarAdler32,    sseAdler32,    avxAdler32}},
+    {"crc16",      4, {tblCrc16,         tblCrc16,      tblCrc16}},
+    {"crc32",      8, {tblCrc32,         tblCrc32,      tblCrc32}},
+};
+static const CS_FUNC refTbl[NUM_ALG] = {refSum16, refFletcher32, refAdler32, refCrc16, refCrc32};
+static const char *const kernNames[NUM_KERN] = {"scalar", "sse", "avx2"};
+
+static uint16_t crc16Tbl[256];
+static uint32_t crc32Tbl[8][256];
+
+/****************************************************************************************
+* Reference kernels - one byte at a time, as on the board. CalcChkSum() is the
+* reference for sum16.
+****************************************************************************************/
+static uint32_t refSum16(const uint8_t *d, size_t n){
+    uint16_t c_sum = 0;
+    size_t i;
+    for(i = 0; i < n; i++){
+        c_sum += (uint16_t)d[i];
+    }
+    return c_sum;
+}
+
+static uint32_t refFletcher32(const uint8_t *d, size_t n){
+    uint32_t a = 0;
+    uint32_t b = 0;
+    uint32_t word;
+    size_t i;
+    for(i = 0; i < n; i += 2){
+        word = d[i];
+        if((i + 1) < n){
+            word |= (uint32_t)d[i + 1] << 8;
+        }
+        a = (a + word) % FLETCHER_MOD;
+        b = (b + a) % FLETCHER_MOD;
+    }
+    return (b << 16) | a;
+}
+
+static uint32_t refAdler32(const uint8_t *d, size_t n){
+    uint32_t a = 1;
+    uint32_t b = 0;
+    size_t i;
+    for(i = 0; i < n; i++){
+        a = (a + d[i]) % ADLER_MOD;
+        b = (b + a) % ADLER_MOD;
+    }
+    return (b << 16) | a;
+}
+
+static uint32_t refCrc16(const uint8_t *d, size_t n){
+    uint32_t crc = CRC16_INIT;
+    size_t i;
+    int bit;
+    for(i = 0; i < n; i++){
+        crc ^= (uint32_t)d[i] << 8;
+        for(bit = 0; bit < 8; bit++){
+            crc = (crc & 0x8000U) ? ((crc << 1) ^ CRC16_POLY) : (crc << 1);
+        }
+        crc &= 0xFFFFU;
+    }
+    return crc;
+}
+
+static uint32_t refCrc32(const uint8_t *d, size_t n){
+    uint32_t crc = CRC32_INIT;
+    size_t i;
+    int bit;
+    for(i = 0; i < n; i++){
+        crc ^= d[i];
+        for(bit = 0; bit < 8; bit++){
+            crc = (crc & 1U) ? ((crc >> 1) ^ CRC32_POLY) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+/****************************************************************************************
+* Scalar kernels - deferred modulo like the firmware, tables for the CRCs.
+****************************************************************************************/
+static uint32_t scalarSum16(const uint8_t *d, size_t n){
+    uint64_t sum = 0;
+    size_t i;
+    for(i = 0; i < n; i++){
+        sum += d[i];
+    }
+    return (uint32_t)(sum & 0xFFFFU);
+}
+
+/* Adds the words of whole pairs to a and b, leaves the final odd byte to the caller */
+static void fletcherPairs(const uint8_t *d, size_t words, uint64_t *pa, uint64_t *pb){
+    uint64_t a = *pa;
+    uint64_t b = *pb;
+    size_t blk;
+    while(words > 0){
+        blk = (words > FLETCHER_WORDS) ? FLETCHER_WORDS : words;
+        words -= blk;
+        while(blk > 0){
+            a += (uint32_t)d[0] | ((uint32_t)d[1] << 8);
+            b += a;
+            d += 2;
+            blk--;
+        }
+        a %= FLETCHER_MOD;
+        b %= FLETCHER_MOD;
+    }
+    *pa = a;
+    *pb = b;
+}
+
+static uint32_t fletcherFinish(const uint8_t *d, size_t n, uint64_t a, uint64_t b){
+    if((n & 1U) != 0){
+        a = (a + d[n - 1]) % FLETCHER_MOD;
+        b = (b + a) % FLETCHER_MOD;
+    }
+    return (uint32_t)((b << 16) | a);
+}
+
+static uint32_t scalarFletcher32(const uint8_t *d, size_t n){
+    uint64_t a = 0;
+    uint64_t b = 0;
+    fletcherPairs(d, n >> 1, &a, &b);
+    return fletcherFinish(d, n, a, b);
+}
+
+static void adlerBytes(const uint8_t *d, size_t n, uint64_t *pa, uint64_t *pb){
+    uint64_t a = *pa;
+    uint64_t b = *pb;
+    size_t blk;
+    while(n > 0){
+        blk = (n > ADLER_BYTES) ? ADLER_BYTES : n;
+        n -= blk;
+        while(blk > 0){
+            a += *d;
+            b += a;
+            d++;
+            blk--;
+        }
+        a %= ADLER_MOD;
+        b %= ADLER_MOD;
+    }
+    *pa = a;
+    *pb = b;
+}
+
+static uint32_t scalarAdler32(const uint8_t *d, size_t n){
+    uint64_t a = 1;
+    uint64_t b = 0;
+    adlerBytes(d, n, &a, &b);
+    return (uint32_t)((b << 16) | a);
+}
+
+static void crcTblInit(void){
+    uint32_t i;
+    uint32_t c16;
+    uint32_t c32;
+    int bit;
+    int s;
+    for(i = 0; i < 256U; i++){
+        c16 = i << 8;
+        c32 = i;
+        for(bit = 0; bit < 8; bit++){
+            c16 = (c16 & 0x8000U) ? ((c16 << 1) ^ CRC16_POLY) : (c16 << 1);
+            c32 = (c32 & 1U) ? ((c32 >> 1) ^ CRC32_POLY) : (c32 >> 1);
+        }
+        crc16Tbl[i] = (uint16_t)c16;
+        crc32Tbl[0][i] = c32;
+    }
+    /* Slice by 8: table s advances a byte through s more zero bytes */
+    for(s = 1; s < 8; s++){
+        for(i = 0; i < 256U; i++){
+            c32 = crc32Tbl[s - 1][i];
+            crc32Tbl[s][i] = (c32 >> 8) ^ crc32Tbl[0][c32 & 0xFFU];
+        }
+    }
+}
+
+static uint32_t tblCrc16(const uint8_t *d, size_t n){
+    uint32_t crc = CRC16_INIT;
+    while(n > 0){
+        crc = ((crc << 8) & 0xFFFFU) ^ crc16Tbl[((crc >> 8) ^ *d) & 0xFFU];
+        d++;
+        n--;
+    }
+    return crc;
+}
+
+static uint32_t tblCrc32(const uint8_t *d, size_t n){
+    uint32_t crc = CRC32_INIT;
+    uint32_t lo;
+    uint32_t hi;
+    while(n >= 8U){
+        memcpy(&lo, d, 4);
+        memcpy(&hi, d + 4, 4);
+        lo ^= crc;
+        crc = crc32Tbl[7][lo & 0xFFU] ^ crc32Tbl[6][(lo >> 8) & 0xFFU] ^
+              crc32Tbl[5][(lo >> 16) & 0xFFU] ^ crc32Tbl[4][lo >> 24] ^
+              crc32Tbl[3][hi & 0xFFU] ^ crc32Tbl[2][(hi >> 8) & 0xFFU] ^
+              crc32Tbl[1][(hi >> 16) & 0xFFU] ^ crc32Tbl[0][hi >> 24];
+        d += 8;
+        n -= 8;
+    }
+    while(n > 0){
+        crc = (crc >> 8) ^ crc32Tbl[0][(crc ^ *d) & 0xFFU];
+        d++;
+        n--;
+    }
+    return ~crc;
+}
+
+/****************************************************************************************
+* SSE4.1 kernels - 16 bytes per step. The byte and word sums are kept in vector
+* lanes and only reduced once per chunk, the tail goes to the scalar code.
+*
+* For a chunk of blocks the weighted sum b is rebuilt from three lane sums:
+*   s1 - sum of all elements
+*   s2 - each block's elements weighted by their distance from the block end
+*   s3 - s1 as it was before each block, times the block length
+****************************************************************************************/
+__attribute__((target("sse4.1")))
+static uint32_t sseSum16(const uint8_t *d, size_t n){
+    __m128i acc = _mm_setzero_si128();
+    __m128i zero = _mm_setzero_si128();
+    uint64_t sum;
+    while(n >= 16U){
+        acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i *)d), zero));
+        d += 16;
+        n -= 16;
+    }
+    sum = (uint64_t)_mm_cvtsi128_si64(acc) + (uint64_t)_mm_extract_epi64(acc, 1);
+    return (uint32_t)((sum + scalarSum16(d, n)) & 0xFFFFU);
+}
+
+__attribute__((target("sse4.1")))
+static uint64_t sseHsum32(__m128i v){
+    return (uint64_t)(uint32_t)_mm_extract_epi32(v, 0) + (uint32_t)_mm_extract_epi32(v, 1) +
+           (uint64_t)(uint32_t)_mm_extract_epi32(v, 2) + (uint32_t)_mm_extract_epi32(v, 3);
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t sseFletcher32(const uint8_t *d, size_t n){
+    const __m128i tap0 = _mm_setr_epi32(8, 7, 6, 5);
+    const __m128i tap1 = _mm_setr_epi32(4, 3, 2, 1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    size_t blocks;
+    size_t chunk;
+    __m128i s1;
+    __m128i s2;
+    __m128i s3;
+    __m128i x;
+    __m128i w0;
+    __m128i w1;
+    while(n >= 16U){
+        chunk = (n > SIMD_CHUNK) ? SIMD_CHUNK : (n & ~(size_t)15U);
+        blocks = chunk >> 4;
+        s1 = _mm_setzero_si128();
+        s2 = _mm_setzero_si128();
+        s3 = _mm_setzero_si128();
+        while(blocks > 0){
+            x = _mm_loadu_si128((const __m128i *)d);
+            w0 = _mm_cvtepu16_epi32(x);
+            w1 = _mm_cvtepu16_epi32(_mm_srli_si128(x, 8));
+            s3 = _mm_add_epi32(s3, s1);
+            s1 = _mm_add_epi32(s1, _mm_add_epi32(w0, w1));
+            s2 = _mm_add_epi32(s2, _mm_add_epi32(_mm_mullo_epi32(w0, tap0), _mm_mullo_epi32(w1, tap1)));
+            d += 16;
+            blocks--;
+        }
+        b = (b + (chunk >> 1) * a + 8U * sseHsum32(s3) + sseHsum32(s2)) % FLETCHER_MOD;
+        a = (a + sseHsum32(s1)) % FLETCHER_MOD;
+        n -= chunk;
+    }
+    fletcherPairs(d, n >> 1, &a, &b);
+    return fletcherFinish(d, n, a, b);
+}
+
+__attribute__((target("sse4.1")))
+static uint32_t sseAdler32(const uint8_t *d, size_t n){
+    const __m128i tap = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m128i ones = _mm_set1_epi16(1);
+    const __m128i zero = _mm_setzero_si128();
+    uint64_t a = 1;
+    uint64_t b = 0;
+    size_t blocks;
+    size_t chunk;
+    __m128i s1;
+    __m128i s2;
+    __m128i s3;
+    __m128i x;
+    while(n >= 16U){
+        chunk = (n > ADLER_SIMD_CHUNK) ? ADLER_SIMD_CHUNK : (n & ~(size_t)15U);
+        blocks = chunk >> 4;
+        s1 = _mm_setzero_si128();
+        s2 = _mm_setzero_si128();
+        s3 = _mm_setzero_si128();
+        while(blocks > 0){
+            x = _mm_loadu_si128((const __m128i *)d);
+            s3 = _mm_add_epi32(s3, s1);
+            s1 = _mm_add_epi32(s1, _mm_sad_epu8(x, zero));
+            s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_maddubs_epi16(x, tap), ones));
+            d += 16;
+            blocks--;
+        }
+        b = (b + chunk * a + 16U * sseHsum32(s3) + sseHsum32(s2)) % ADLER_MOD;
+        a = (a + sseHsum32(s1)) % ADLER_MOD;
+        n -= chunk;
+    }
+    adlerBytes(d, n, &a, &b);
+    return (uint32_t)((b << 16) | a);
+}
+
+/****************************************************************************************
+* AVX2 kernels - the SSE4.1 kernels with 32 byte steps.
+****************************************************************************************/
+__attribute__((target("avx2")))
+static uint64_t avxHsum32(__m256i v){
+    __m128i x = _mm_add_epi64(_mm_cvtepu32_epi64(_mm256_castsi256_si128(v)),
+                              _mm_cvtepu32_epi64(_mm_srli_si128(_mm256_castsi256_si128(v), 8)));
+    __m128i y = _mm256_extracti128_si256(v, 1);
+    x = _mm_add_epi64(x, _mm_add_epi64(_mm_cvtepu32_epi64(y), _mm_cvtepu32_epi64(_mm_srli_si128(y, 8))));
+    return (uint64_t)_mm_cvtsi128_si64(x) + (uint64_t)_mm_extract_epi64(x, 1);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avxSum16(const uint8_t *d, size_t n){
+    __m256i acc = _mm256_setzero_si256();
+    __m256i zero = _mm256_setzero_si256();
+    __m128i x;
+    uint64_t sum;
+    while(n >= 32U){
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i *)d), zero));
+        d += 32;
+        n -= 32;
+    }
+    x = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    sum = (uint64_t)_mm_cvtsi128_si64(x) + (uint64_t)_mm_extract_epi64(x, 1);
+    return (uint32_t)((sum + scalarSum16(d, n)) & 0xFFFFU);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avxFletcher32(const uint8_t *d, size_t n){
+    const __m256i tap0 = _mm256_setr_epi32(16, 15, 14, 13, 12, 11, 10, 9);
+    const __m256i tap1 = _mm256_setr_epi32(8, 7, 6, 5, 4, 3, 2, 1);
+    uint64_t a = 0;
+    uint64_t b = 0;
+    size_t blocks;
+    size_t chunk;
+    __m256i s1;
+    __m256i s2;
+    __m256i s3;
+    __m256i w0;
+    __m256i w1;
+    while(n >= 32U){
+        chunk = (n > SIMD_CHUNK) ? SIMD_CHUNK : (n & ~(size_t)31U);
+        blocks = chunk >> 5;
+        s1 = _mm256_setzero_si256();
+        s2 = _mm256_setzero_si256();
+        s3 = _mm256_setzero_si256();
+        while(blocks > 0){
+            w0 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)d));
+            w1 = _mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i *)(d + 16)));
+            s3 = _mm256_add_epi32(s3, s1);
+            s1 = _mm256_add_epi32(s1, _mm256_add_epi32(w0, w1));
+            s2 = _mm256_add_epi32(s2, _mm256_add_epi32(_mm256_mullo_epi32(w0, tap0),
+                                                       _mm256_mullo_epi32(w1, tap1)));
+            d += 32;
+            blocks--;
+        }
+        b = (b + (chunk >> 1) * a + 16U * avxHsum32(s3) + avxHsum32(s2)) % FLETCHER_MOD;
+        a = (a + avxHsum32(s1)) % FLETCHER_MOD;
+        n -= chunk;
+    }
+    fletcherPairs(d, n >> 1, &a, &b);
+    return fletcherFinish(d, n, a, b);
+}
+
+__attribute__((target("avx2")))
+static uint32_t avxAdler32(const uint8_t *d, size_t n){
+    const __m256i tap = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                         16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+    const __m256i ones = _mm256_set1_epi16(1);
+    const __m256i zero = _mm256_setzero_si256();
+    uint64_t a = 1;
+    uint64_t b = 0;
+    size_t blocks;
+    size_t chunk;
+    __m256i s1;
+    __m256i s2;
+    __m256i s3;
+    __m256i x;
+    while(n >= 32U){
+        chunk = (n > ADLER_SIMD_CHUNK) ? ADLER_SIMD_CHUNK : (n & ~(size_t)31U);
+        blocks = chunk >> 5;
+        s1 = _mm256_setzero_si256();
+        s2 = _mm256_setzero_si256();
+        s3 = _mm256_setzero_si256();
+        while(blocks > 0){
+            x = _mm256_loadu_si256((const __m256i *)d);
+            s3 = _mm256_add_epi32(s3, s1);
+            s1 = _mm256_add_epi32(s1, _mm256_sad_epu8(x, zero));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_maddubs_epi16(x, tap), ones));
+            d += 32;
+            blocks--;
+        }
+        b = (b + chunk * a + 32U * avxHsum32(s3) + avxHsum32(s2)) % ADLER_MOD;
+        a = (a + avxHsum32(s1)) % ADLER_MOD;
+        n -= chunk;
+    }
+    adlerBytes(d, n, &a, &b);
+    return (uint32_t)((b << 16) | a);
+}
+
+/****************************************************************************************
+* Kernel selection
+****************************************************************************************/
+static int kernSupported(int kern){
+    int ok = 1;
+    __builtin_cpu_init();
+    if(kern == KERN_AVX2){
+        ok = __builtin_cpu_supports("avx2");
+    }else if(kern == KERN_SSE){
+        ok = __builtin_cpu_supports("sse4.1") && __builtin_cpu_supports("ssse3");
+    }else{
+    }
+    return ok;
+}
+
+static int kernBest(void){
+    int kern = NUM_KERN - 1;
+    while((kern > KERN_SCALAR) && (kernSupported(kern) == 0)){
+        kern--;
+    }
+    return kern;
+}
+
+/****************************************************************************************
+* selfTest() - Every supported kernel of every algorithm against the reference
+*              over random data of many lengths and alignments, plus the
+*              standard check values.
+****************************************************************************************/
+static int selfTest(void){
+    static const struct{
+        int alg;
+        const char *data;
+        uint32_t check;
+    }vectors[] = {
+        {ALG_CRC16,      "123456789", 0x29B1U},
+        {ALG_CRC32,      "123456789", 0xCBF43926U},
+        {ALG_FLETCHER32, "abcde",     0xF04FC729U},
+        {ALG_FLETCHER32, "abcdef",    0x56502D2AU},
+        {ALG_ADLER32,    "Wikipedia", 0x11E60398U},
+    };
+    size_t bufsz = 3U * SIMD_CHUNK * 4U;
+    uint8_t *buf = malloc(bufsz + 64U);
+    size_t lens[] = {0, 1, 2, 3, 15, 16, 17, 31, 32, 33, 63, 64, 65, 255, 4095, 4096, 4097,
+                     5535, 5536, 5537, 5552, 5553, 8192, 11111, 3U * SIMD_CHUNK * 4U};
+    size_t i;
+    size_t li;
+    size_t off;
+    int alg;
+    int kern;
+    int pass;
+    int fails = 0;
+    uint32_t ref;
+    uint32_t got;
+
+    if(buf == NULL){
+        return 1;
+    }
+    srand(1);
+    for(i = 0; i < sizeof(vectors)/sizeof(vectors[0]); i++){
+        for(kern = 0; kern < NUM_KERN; kern++){
+            if(kernSupported(kern)){
+                got = algTbl[vectors[i].alg].kern[kern]((const uint8_t *)vectors[i].data,
+                                                        strlen(vectors[i].data));
+                if(got != vectors[i].check){
+                    printf("FAIL %s %s \"%s\" %08X expected %08X\n", algTbl[vectors[i].alg].name,
+                           kernNames[kern], vectors[i].data, got, vectors[i].check);
+                    fails++;
+                }
+            }
+        }
+    }
+    /* Random bytes, then all 0xFF and all 0x00 for the largest lane sums */
+    for(pass = 0; pass < 3; pass++){
+        for(i = 0; i < bufsz + 64U; i++){
+            buf[i] = (pass == 0) ? (uint8_t)rand() : ((pass == 1) ? CS_ERASED : 0U);
+        }
+        for(alg = 0; alg < NUM_ALG; alg++){
+            for(li = 0; li < sizeof(lens)/sizeof(lens[0]); li++){
+                for(off = 0; off < 33U; off += 11U){
+                    ref = refTbl[alg](buf + off, lens[li]);
+                    for(kern = 0; kern < NUM_KERN; kern++){
+                        if(kernSupported(kern)){
+                            got = algTbl[alg].kern[kern](buf + off, lens[li]);
+                            if(got != ref){
+                                printf("FAIL %s %s len %zu off %zu: %08X ref %08X\n",
+                                       algTbl[alg].name, kernNames[kern], lens[li], off, got, ref);
+                                fails++;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    free(buf);
+    for(kern = 0; kern < NUM_KERN; kern++){
+        printf("%-7s %s\n", kernNames[kern], kernSupported(kern) ? "tested" : "not supported here");
+    }
+    printf("selftest: %s\n", (fails == 0) ? "ok" : "FAILED");
+    return (fails == 0) ? 0 : 1;
+}
+
+/****************************************************************************************
+* Image loading. Data outside low..high is reported once and ignored.
+****************************************************************************************/
+typedef struct{
+    uint8_t *mem;
+    uint32_t low;
+    uint32_t high;
+    int outside;
+}IMAGE;
+
+static void imgPut(IMAGE *img, uint32_t addr, const uint8_t *data, size_t len){
+    size_t i;
+    for(i = 0; i < len; i++){
+        if((addr + i >= img->low) && (addr + i <= img->high)){
+            img->mem[addr + i - img->low] = data[i];
+        }else{
+            img->outside = 1;
+        }
+    }
+}
+
+static int hexVal(const char *p, int ndig, uint32_t *val){
+    int i;
+    int c;
+    uint32_t v = 0;
+    for(i = 0; i < ndig; i++){
+        c = p[i];
+        if((c >= '0') && (c <= '9')){
+            v = (v << 4) | (uint32_t)(c - '0');
+        }else if((c >= 'A') && (c <= 'F')){
+            v = (v << 4) | (uint32_t)(c - 'A' + 10);
+        }else if((c >= 'a') && (c <= 'f')){
+            v = (v << 4) | (uint32_t)(c - 'a' + 10);
+        }else{
+            return -1;
+        }
+    }
+    *val = v;
+    return 0;
+}
+
+/* Reads count hex byte pairs from p into out, returns -1 on a bad digit */
+static int hexBytes(const char *p, size_t count, uint8_t *out){
+    size_t i;
+    uint32_t v;
+    for(i = 0; i < count; i++){
+        if(hexVal(p + 2U * i, 2, &v) != 0){
+            return -1;
+        }
+        out[i] = (uint8_t)v;
+    }
+    return 0;
+}
+
+static size_t lineLen(const char *p, const char *end){
+    const char *q = p;
+    while((q < end) && (*q != '\n') && (*q != '\r')){
+        q++;
+    }
+    return (size_t)(q - p);
+}
+
+static int loadSrec(IMAGE *img, const char *p, const char *end){
+    uint8_t rec[260];
+    size_t len;
+    size_t i;
+    uint32_t count;
+    uint32_t addr;
+    int alen;
+    int line = 0;
+    uint8_t sum;
+    while(p < end){
+        len = lineLen(p, end);
+        line++;
+        if((len > 0) && (p[0] == 'S')){
+            alen = (p[1] == '1') ? 2 : ((p[1] == '2') ? 3 : ((p[1] == '3') ? 4 : 0));
+            if((len < 4U) || (hexVal(p + 2, 2, &count) != 0) || (len < 4U + 2U * count) ||
+               (hexBytes(p + 2, count + 1U, rec) != 0)){
+                fprintf(stderr, "line %d: bad S-record\n", line);
+                return -1;
+            }
+            sum = 0;
+            for(i = 0; i <= count; i++){
+                sum += rec[i];
+            }
+            if(sum != 0xFFU){
+                fprintf(stderr, "line %d: S-record checksum error\n", line);
+                return -1;
+            }
+            if((alen > 0) && (count >= (uint32_t)alen + 1U)){
+                addr = 0;
+                for(i = 1; i <= (size_t)alen; i++){
+                    addr = (addr << 8) | rec[i];
+                }
+                imgPut(img, addr, rec + 1 + alen, count - (uint32_t)alen - 1U);
+            }
+        }
+        p += len;
+        while((p < end) && ((*p == '\n') || (*p == '\r'))){
+            p++;
+        }
+    }
+    return 0;
+}
+
+static int loadHex(IMAGE *img, const char *p, const char *end){
+    uint8_t rec[260];
+    size_t len;
+    size_t i;
+    uint32_t count;
+    uint32_t base = 0;
+    int line = 0;
+    uint8_t sum;
+    int done = 0;
+    while((p < end) && (done == 0)){
+        len = lineLen(p, end);
+        line++;
+        if((len > 0) && (p[0] == ':')){
+            if((len < 11U) || (hexVal(p + 1, 2, &count) != 0) || (len < 11U + 2U * count) ||
+               (hexBytes(p + 1, count + 5U, rec) != 0)){
+                fprintf(stderr, "line %d: bad hex record\n", line);
+                return -1;
+            }
+            sum = 0;
+            for(i = 0; i < count + 5U; i++){
+                sum += rec[i];
+            }
+            if(sum != 0){
+                fprintf(stderr, "line %d: hex record checksum error\n", line);
+                return -1;
+            }
+            switch(rec[3]){
+            case 0x00:
+                imgPut(img, base + (((uint32_t)rec[1] << 8) | rec[2]), rec + 4, count);
+                break;
+            case 0x01:
+                done = 1;
+                break;
+            case 0x02:
+                base = (((uint32_t)rec[4] << 8) | rec[5]) << 4;
+                break;
+            case 0x04:
+                base = (((uint32_t)rec[4] << 8) | rec[5]) << 16;
+                break;
+            default:
+                break;
+            }
+        }
+        p += len;
+        while((p < end) && ((*p == '\n') || (*p == '\r'))){
+            p++;
+        }
+    }
+    return 0;
+}
+
+static int fmtFromName(const char *name){
+    const char *dot = strrchr(name, '.');
+    int fmt = FMT_BIN;
+    if(dot != NULL){
+        if((strcasecmp(dot, ".srec") == 0) || (strcasecmp(dot, ".s19") == 0) ||
+           (strcasecmp(dot, ".s28") == 0) || (strcasecmp(dot, ".s37") == 0)){
+            fmt = FMT_SREC;
+        }else if(strcasecmp(dot, ".hex") == 0){
+            fmt = FMT_HEX;
+        }else{
+        }
+    }
+    return fmt;
+}
+
+static int findName(const char *name, const char *const *names, int n){
+    int i = 0;
+    while((i < n) && (strcmp(name, names[i]) != 0)){
+        i++;
+    }
+    return i;
+}
+
+static void usage(void){
+    fprintf(stderr,
+        "usage: cschk [-a alg|all] [-k scalar|sse|avx2] [-f bin|srec|hex]\n"
+        "             [-b base] [-l low] [-h high] [-v] image\n"
+        "       cschk --selftest\n"
+        "alg: sum16 (default) fletcher32 adler32 crc16 crc32\n");
+}
+
+int main(int argc, char **argv){
+    static const char *const fmtNames[] = {"bin", "srec", "hex"};
+    const char *algNames[NUM_ALG];
+    const char *file = NULL;
+    IMAGE img;
+    struct stat st;
+    struct timespec t0;
+    struct timespec t1;
+    const char *map;
+    size_t size;
+    uint32_t base = 0;
+    uint32_t sum;
+    double secs;
+    int alg = ALG_SUM16;
+    int all = 0;
+    int kern = -1;
+    int fmt = -1;
+    int verbose = 0;
+    int fd;
+    int i;
+    int a;
+    int rval = 0;
+
+    crcTblInit();
+    for(a = 0; a < NUM_ALG; a++){
+        algNames[a] = algTbl[a].name;
+    }
+    img.low = CS_LOW_DEF;
+    img.high = CS_HIGH_DEF;
+    img.outside = 0;
+
+    for(i = 1; i < argc; i++){
+        if(strcmp(argv[i], "--selftest") == 0){
+            return selfTest();
+        }else if(strcmp(argv[i], "-v") == 0){
+            verbose = 1;
+        }else if((argv[i][0] == '-') && (argv[i][1] != '\0') && (argv[i][2] == '\0') && (i + 1 < argc)){
+            i++;
+            switch(argv[i - 1][1]){
+            case 'a':
+                if(strcmp(argv[i], "all") == 0){
+                    all = 1;
+                }else if((alg = findName(argv[i], algNames, NUM_ALG)) >= NUM_ALG){
+                    usage();
+                    return 2;
+                }
+                break;
+            case 'k':
+                if((kern = findName(argv[i], kernNames, NUM_KERN)) >= NUM_KERN){
+                    usage();
+                    return 2;
+                }
+                break;
+            case 'f':
+                if((fmt = findName(argv[i], fmtNames, 3)) >= 3){
+                    usage();
+                    return 2;
+                }
+                break;
+            case 'b':
+                base = (uint32_t)strtoul(argv[i], NULL, 16);
+                break;
+            case 'l':
+                img.low = (uint32_t)strtoul(argv[i], NULL, 16);
+                break;
+            case 'h':
+                img.high = (uint32_t)strtoul(argv[i], NULL, 16);
+                break;
+            default:
+                usage();
+                return 2;
+            }
+        }else if((argv[i][0] != '-') && (file == NULL)){
+            file = argv[i];
+        }else{
+            usage();
+            return 2;
+        }
+    }
+    if((file == NULL) || (img.low > img.high)){
+        usage();
+        return 2;
+    }
+    if(kern < 0){
+        kern = kernBest();
+    }else if(kernSupported(kern) == 0){
+        fprintf(stderr, "%s kernel not supported by this CPU\n", kernNames[kern]);
+        return 2;
+    }
+    if(fmt < 0){
+        fmt = fmtFromName(file);
+    }
+
+    size = (size_t)(img.high - img.low) + 1U;
+    img.mem = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    fd = open(file, O_RDONLY);
+    if((img.mem == MAP_FAILED) || (fd < 0) || (fstat(fd, &st) != 0)){
+        perror(file);
+        return 2;
+    }
+    memset(img.mem, CS_ERASED, size);
+    map = NULL;
+    if(st.st_size > 0){
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(map == MAP_FAILED){
+            perror(file);
+            return 2;
+        }
+        if(fmt == FMT_SREC){
+            rval = loadSrec(&img, map, map + st.st_size);
+        }else if(fmt == FMT_HEX){
+            rval = loadHex(&img, map, map + st.st_size);
+        }else{
+            imgPut(&img, base, (const uint8_t *)map, (size_t)st.st_size);
+        }
+        munmap((void *)map, (size_t)st.st_size);
+    }
+    close(fd);
+    if(rval != 0){
+        return 2;
+    }
+    if(img.outside != 0){
+        fprintf(stderr, "warning: data outside %08X-%08X ignored\n", img.low, img.high);
+    }
+
+    for(a = 0; a < NUM_ALG; a++){
+        if((a == alg) || (all != 0)){
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            sum = algTbl[a].kern[kern](img.mem, size);
+            clock_gettime(CLOCK_MONOTONIC, &t1);
+            printf("CS : %08X-%08X %0*X", img.low, img.high, algTbl[a].digits, sum);
+            if((a != ALG_SUM16) || (all != 0)){
+                printf("  %s", algTbl[a].name);
+            }
+            if(verbose != 0){
+                secs = (double)(t1.tv_sec - t0.tv_sec) + (double)(t1.tv_nsec - t0.tv_nsec) * 1e-9;
+                printf("  %s %.1f MB/s", kernNames[kern], (secs > 0.0) ? ((double)size / secs / 1e6) : 0.0);
+            }
+            printf("\n");
+        }
+    }
+    munmap(img.mem, size);
+    return 0;
+}
@@ -0,0 +1,235 @@
+/****************************************************************************************
+* quantchk.c - Host side check of the quantile sketch in source/Quant.c.
+*
+*   The bucket and quantile code below is the firmware's, with stdint types
+*   and __builtin_clz for __CLZ. Given a list of samples it prints the p50,
+*   p90, p99 and p99.9 the board would report next to the exact nearest rank
+*   quantiles of the sorted samples. --selftest runs a set of distributions
+*   and checks every estimate is within the documented bound: exact below
+*   2^SUB_BITS, within 1/2^(SUB_BITS+1) of the exact value above that.
+*
+*   Build:  gcc -O2 -Wall -o quantchk tools/quantchk.c -lm
+*   Usage:  quantchk [file]      samples as decimal numbers, stdin without file
+*           quantchk --selftest
+*
+****************************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define QUANT_SUB_BITS      4U
+#define QUANT_SUB           (1U << QUANT_SUB_BITS)
+#define QUANT_BUCKETS       ((32U - QUANT_SUB_BITS + 1U) * QUANT_SUB)
+#define QUANT_Q_FULL        10000U
+
+#define NUM_PCT             4
+
+static const uint16_t pcts[NUM_PCT] = {5000U, 9000U, 9900U, 9990U};
+static const char *const pctNames[NUM_PCT] = {"p50", "p90", "p99", "p99.9"};
+
+typedef struct{
+    uint32_t hist[QUANT_BUCKETS];
+    uint32_t n;
+}SKETCH;
+
+/****************************************************************************************
+* Firmware sketch, from source/Quant.c
+****************************************************************************************/
+static uint16_t quantIdx(uint32_t val){
+    uint32_t e;
+    uint16_t idx;
+    if(val < QUANT_SUB){
+        idx = (uint16_t)val;
+    }else{
+        e = 31U - (uint32_t)__builtin_clz(val);
+        idx = (uint16_t)(((e - QUANT_SUB_BITS + 1U) * QUANT_SUB) +
+                         ((val >> (e - QUANT_SUB_BITS)) & (QUANT_SUB - 1U)));
+    }
+    return idx;
+}
+
+static uint32_t quantMid(uint16_t idx){
+    uint32_t e;
+    uint32_t low;
+    uint32_t mid;
+    if(idx < QUANT_SUB){
+        mid = idx;
+    }else{
+        e = (idx / QUANT_SUB) + QUANT_SUB_BITS - 1U;
+        low = (1UL << e) + ((uint32_t)(idx & (QUANT_SUB - 1U)) << (e - QUANT_SUB_BITS));
+        mid = low + ((1UL << (e - QUANT_SUB_BITS)) >> 1);
+    }
+    return mid;
+}
+
+static void quantAdd(SKETCH *sk, uint32_t val){
+    sk->hist[quantIdx(val)]++;
+    sk->n++;
+}
+
+static uint32_t quantRank(uint32_t n, uint16_t q){
+    uint32_t rank = (uint32_t)((((uint64_t)n * q) + (QUANT_Q_FULL - 1U)) / QUANT_Q_FULL);
+    return (rank == 0) ? 1U : rank;
+}
+
+static uint32_t quantGet(const SKETCH *sk, uint16_t q){
+    uint32_t rank;
+    uint32_t cum;
+    uint16_t idx = 0;
+    uint32_t est = 0;
+    if(sk->n != 0){
+        rank = quantRank(sk->n, q);
+        cum = sk->hist[0];
+        while(cum < rank){
+            idx++;
+            cum += sk->hist[idx];
+        }
+        est = quantMid(idx);
+    }
+    return est;
+}
+
+/****************************************************************************************
+* Exact quantiles
+****************************************************************************************/
+static int cmpU32(const void *a, const void *b){
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+static uint32_t exactGet(const uint32_t *sorted, uint32_t n, uint16_t q){
+    return (n == 0) ? 0U : sorted[quantRank(n, q) - 1U];
+}
+
+/* Largest error the bucket width allows for the exact value x */
+static uint32_t errBound(uint32_t x){
+    return (x < QUANT_SUB) ? 0U : x >> (QUANT_SUB_BITS + 1U);
+}
+
+/****************************************************************************************
+* Compares the sketch of n samples against sorting them. Returns the number of
+* estimates over the bound, prints every row if verbose.
+****************************************************************************************/
+static int check(const char *name, uint32_t *val, uint32_t n, int verbose){
+    static SKETCH sk;
+    uint32_t i;
+    uint32_t est;
+    uint32_t ex;
+    uint32_t diff;
+    int p;
+    int fails = 0;
+
+    memset(&sk, 0, sizeof(sk));
+    for(i = 0; i < n; i++){
+        quantAdd(&sk, val[i]);
+    }
+    qsort(val, n, sizeof(val[0]), cmpU32);
+    for(p = 0; p < NUM_PCT; p++){
+        est = quantGet(&sk, pcts[p]);
+        ex = exactGet(val, n, pcts[p]);
+        diff = (est > ex) ? (est - ex) : (ex - est);
+        if(diff > errBound(ex)){
+            fails++;
+            printf("FAIL %s n %u %s: %u exact %u\n", name, n, pctNames[p], est, ex);
+        }else if(verbose){
+            printf("%-6s %12u %12u %8.3f%%\n", pctNames[p], est, ex,
+                   (ex == 0) ? 0.0 : (100.0 * diff / ex));
+        }
+    }
+    return fails;
+}
+
+static uint32_t rnd32(void){
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+static int selfTest(void){
+    static const uint32_t sizes[] = {1, 2, 3, 10, 999, 1000, 1001, 65536};
+    static const char *const dists[] = {"const", "small", "uniform", "exp", "lognorm",
+                                        "bimodal", "top"};
+    const int ndist = (int)(sizeof(dists)/sizeof(dists[0]));
+    uint32_t *val = malloc(sizeof(uint32_t) * 65536U);
+    uint32_t i;
+    size_t si;
+    double u;
+    int d;
+    int fails = 0;
+
+    if(val == NULL){
+        return 1;
+    }
+    srand(1);
+    for(d = 0; d < ndist; d++){
+        for(si = 0; si < sizeof(sizes)/sizeof(sizes[0]); si++){
+            for(i = 0; i < sizes[si]; i++){
+                u = (rand() + 1.0) / (RAND_MAX + 2.0);
+                switch(d){
+                case 0:  val[i] = 180000U; break;
+                case 1:  val[i] = (uint32_t)rand() % 40U; break;
+                case 2:  val[i] = rnd32(); break;
+                case 3:  val[i] = (uint32_t)(-log(u) * 180000.0); break;
+                case 4:  val[i] = (uint32_t)exp(12.0 + 2.0 * sqrt(-2.0 * log(u)) *
+                                                cos(6.2831853 * rand() / (double)RAND_MAX));
+                         break;
+                case 5:  val[i] = (rand() & 1) ? 120U + (uint32_t)rand() % 8U
+                                               : 90000000U + (uint32_t)rand() % 1000U;
+                         break;
+                default: val[i] = 0xFFFFFFFFU - ((uint32_t)rand() % 4096U); break;
+                }
+            }
+            fails += check(dists[d], val, sizes[si], 0);
+        }
+    }
+    free(val);
+    printf("selftest: %s\n", (fails == 0) ? "ok" : "FAILED");
+    return (fails == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv){
+    FILE *in = stdin;
+    uint32_t *val = NULL;
+    uint32_t *grow;
+    uint32_t n = 0;
+    uint32_t cap = 0;
+    unsigned long v;
+    int rval;
+
+    if((argc > 1) && (strcmp(argv[1], "--selftest") == 0)){
+        return selfTest();
+    }
+    if(argc > 2){
+        fprintf(stderr, "usage: quantchk [file]\n       quantchk --selftest\n");
+        return 2;
+    }
+    if(argc == 2){
+        in = fopen(argv[1], "r");
+        if(in == NULL){
+            perror(argv[1]);
+            return 1;
+        }
+    }
+    while(fscanf(in, "%lu", &v) == 1){
+        if(n == cap){
+            cap = (cap == 0) ? 4096U : cap * 2U;
+            grow = realloc(val, sizeof(uint32_t) * cap);
+            if(grow == NULL){
+                free(val);
+                return 1;
+            }
+            val = grow;
+        }
+        val[n] = (uint32_t)v;
+        n++;
+    }
+    if(in != stdin){
+        fclose(in);
+    }
+    printf("%u samples\n", n);
+    printf("%-6s %12s %12s %9s\n", "", "sketch", "exact", "error");
+    rval = (check("input", val, n, 1) == 0) ? 0 : 1;
+    free(val);
+    return rval;
+}